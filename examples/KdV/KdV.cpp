@@ -26,6 +26,15 @@ public:
         return -(6*u*m_ux + m_uxxx);
     }
 
+    /// Fused leap frog update out = base + scale*f(t, u).  The derivative is
+    /// never stored, so the update saves a full write and read of the state.
+    void operator()(ValueType t, StateType const& u, StateType const& base, ValueType scale, StateType& out)
+    {
+        deriv1_4(t, u, m_ux);
+        deriv3_4(t, u, m_uxxx);
+        out = base - scale*(6*u*m_ux + m_uxxx);
+    }
+
     /// Fourth order accurate centered finite difference
     /// approximation to the first derivatve
     void deriv1_4(ValueType t, StateType const& u, StateType& ux)
@@ -21,6 +21,27 @@ public:
         return m_gamma*m_uxx - u*m_ux;
     }
 
+    /// Fused leap frog update out = base + scale*f(t, u).  The stencils are
+    /// applied on the fly, so the interior is a single sweep that never
+    /// stores the derivatives.
+    void operator()(ValueType, StateType const& u, StateType const& base, ValueType scale, StateType& out)
+    {
+        auto n = u.size();
+        auto k = m_k;
+        auto up = u.tail(n-2);
+        auto uc = u.segment(1,n-2);
+        auto um = u.head(n-2);
+        out.segment(1,n-2) = base.segment(1,n-2) + scale*(m_gamma*(up-2*uc+um)/(k*k) - uc*(up-um)/(2*k));
+
+        // one-sided differences at the boundaries
+        ValueType ux0  = (u[1]  -u[0]  )/k;
+        ValueType ux1  = (u[2]  -u[0]  )/(2*k);
+        ValueType uxn1 = (u[n-1]-u[n-2])/k;
+        ValueType uxn2 = (u[n-1]-u[n-3])/(2*k);
+        out[0]   = base[0]   + scale*(m_gamma*(ux1-ux0)/k   - u[0]*ux0);
+        out[n-1] = base[n-1] + scale*(m_gamma*(uxn1-uxn2)/k - u[n-1]*uxn1);
+    }
+
     void gradient1(StateType const& u, StateType& ux)
     {
         auto n = u.size();
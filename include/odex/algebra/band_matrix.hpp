@@ -0,0 +1,202 @@
+
+#ifndef ODEX_ALGEBRA_BAND_MATRIX_HPP
+#define ODEX_ALGEBRA_BAND_MATRIX_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <cmath>
+
+namespace odex {
+namespace algebra {
+
+/// Square matrix with lower and upper bandwidths, used for Jacobians and the
+/// linear systems of the linearly implicit steppers.  Full bandwidths, the
+/// default, make it a dense matrix.  Each row stores the columns of its band
+/// widened by the lower bandwidth, which is where row exchanges during the
+/// LU factorization move entries to, so that a matrix and its factorization
+/// share one layout.  Entries outside the band are zero and must not be set.
+template <class T>
+class band_matrix
+{
+public:
+    using value_type = T;
+
+    band_matrix()
+    : m_size(0)
+    , m_lower(0)
+    , m_upper(0)
+    , m_width(0)
+    , m_values()
+    , m_pivots()
+    {    }
+
+    /// Shape the matrix as size by size with the given bandwidths, which
+    /// default to full, and set every entry to zero.  Storage is only
+    /// allocated when it grows.
+    void resize(std::size_t size, std::size_t lower=std::size_t(-1), std::size_t upper=std::size_t(-1))
+    {
+        m_size = size;
+        m_lower = std::min(lower, size > 0 ? size-1 : 0);
+        m_upper = std::min(upper, size > 0 ? size-1 : 0);
+        m_width = std::min(size, 2*m_lower+m_upper+1);
+        m_values.assign(m_size*m_width, T(0));
+    }
+
+    /// Number of rows and columns.
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    /// Number of subdiagonals in the band.
+    std::size_t lower() const
+    {
+        return m_lower;
+    }
+
+    /// Number of superdiagonals in the band.
+    std::size_t upper() const
+    {
+        return m_upper;
+    }
+
+    /// Entry at row, column, which must lie in the band.
+    T& operator()(std::size_t row, std::size_t column)
+    {
+        assert(column+m_lower >= row && column <= row+m_upper && "entry outside the band!");
+        return m_values[_index(row, column)];
+    }
+
+    T const& operator()(std::size_t row, std::size_t column) const
+    {
+        assert(column+m_lower >= row && column <= row+m_upper && "entry outside the band!");
+        return m_values[_index(row, column)];
+    }
+
+    /// Add scale times this matrix times x to y, for arrays x and y of size()
+    /// values.  The matrix must not have been factored.
+    template <class Scalar, class Value>
+    void multiply_add(Scalar scale, Value const* x, Value* y) const
+    {
+        for (std::size_t ii = 0; ii < m_size; ++ii)
+        {
+            auto const first = ii > m_lower ? ii-m_lower : 0;
+            auto const last = std::min(m_size-1, ii+m_upper);
+            Value sum = 0;
+            for (std::size_t jj = first; jj <= last; ++jj)
+            {
+                sum += static_cast<Value>(m_values[_index(ii, jj)])*x[jj];
+            }
+            y[ii] += static_cast<Value>(scale)*sum;
+        }
+    }
+
+    /// Factor I - h*J into this matrix as an LU factorization with partial
+    /// pivoting, for solve().  Storage is reused once it is large enough.
+    template <class Scalar>
+    void factor(band_matrix const& J, Scalar h)
+    {
+        m_size = J.m_size;
+        m_lower = J.m_lower;
+        m_upper = J.m_upper;
+        m_width = J.m_width;
+        m_values.resize(J.m_values.size());
+        m_pivots.resize(m_size);
+        auto const scale = static_cast<T>(h);
+        for (std::size_t ii = 0; ii < m_values.size(); ++ii)
+        {
+            m_values[ii] = -scale*J.m_values[ii];
+        }
+        for (std::size_t ii = 0; ii < m_size; ++ii)
+        {
+            m_values[_index(ii, ii)] += T(1);
+        }
+
+        // elimination on the rows below the diagonal in the band, with the
+        // pivot row's entries reaching at most lower+upper past the diagonal
+        for (std::size_t kk = 0; kk < m_size; ++kk)
+        {
+            auto const last_row = std::min(m_size-1, kk+m_lower);
+            auto const last_column = std::min(m_size-1, kk+m_lower+m_upper);
+
+            auto pivot = kk;
+            for (std::size_t ii = kk+1; ii <= last_row; ++ii)
+            {
+                if (std::abs(m_values[_index(ii, kk)]) > std::abs(m_values[_index(pivot, kk)]))
+                {
+                    pivot = ii;
+                }
+            }
+            m_pivots[kk] = pivot;
+            if (pivot != kk)
+            {
+                for (std::size_t jj = kk; jj <= last_column; ++jj)
+                {
+                    std::swap(m_values[_index(kk, jj)], m_values[_index(pivot, jj)]);
+                }
+            }
+
+            auto const diagonal = m_values[_index(kk, kk)];
+            assert(diagonal != T(0) && "singular matrix!");
+            for (std::size_t ii = kk+1; ii <= last_row; ++ii)
+            {
+                auto const factor = m_values[_index(ii, kk)]/diagonal;
+                m_values[_index(ii, kk)] = factor;
+                for (std::size_t jj = kk+1; jj <= last_column; ++jj)
+                {
+                    m_values[_index(ii, jj)] -= factor*m_values[_index(kk, jj)];
+                }
+            }
+        }
+    }
+
+    /// Solve the factored system in place, overwriting the right hand side
+    /// b, an array of size() values, with the solution.
+    template <class Value>
+    void solve(Value* b) const
+    {
+        for (std::size_t kk = 0; kk < m_size; ++kk)
+        {
+            std::swap(b[kk], b[m_pivots[kk]]);
+            auto const last_row = std::min(m_size-1, kk+m_lower);
+            for (std::size_t ii = kk+1; ii <= last_row; ++ii)
+            {
+                b[ii] -= static_cast<Value>(m_values[_index(ii, kk)])*b[kk];
+            }
+        }
+        for (std::size_t kk = m_size; kk-- > 0;)
+        {
+            auto const last_column = std::min(m_size-1, kk+m_lower+m_upper);
+            auto sum = b[kk];
+            for (std::size_t jj = kk+1; jj <= last_column; ++jj)
+            {
+                sum -= static_cast<Value>(m_values[_index(kk, jj)])*b[jj];
+            }
+            b[kk] = sum/static_cast<Value>(m_values[_index(kk, kk)]);
+        }
+    }
+
+private:
+    /// Position of an entry of the widened band.  Row ii stores m_width
+    /// columns starting at ii-lower, shifted to stay within the matrix.
+    std::size_t _index(std::size_t row, std::size_t column) const
+    {
+        auto const first = std::min(row > m_lower ? row-m_lower : 0, m_size-m_width);
+        return row*m_width+column-first;
+    }
+
+    std::size_t m_size;
+    std::size_t m_lower;
+    std::size_t m_upper;
+    std::size_t m_width;
+    std::vector<T> m_values;
+    std::vector<std::size_t> m_pivots;
+};
+
+} // namespace algebra
+} // namespace odex
+
+#endif // ODEX_ALGEBRA_BAND_MATRIX_HPP
@@ -0,0 +1,49 @@
+#ifndef ODEX_ALGEBRA_COMBINE_HPP
+#define ODEX_ALGEBRA_COMBINE_HPP
+
+#include "odex/algebra/operations.hpp"
+#include <cstddef>
+
+namespace odex {
+namespace algebra {
+
+/// Combines the elements [first, last) of contiguous states into y, leaving
+/// the rest of y untouched.
+template <class State, class Weight>
+void combine_range(State& y, Weight const* weights, State const* const* inputs,
+                   std::size_t count, std::size_t first, std::size_t last,
+                   summation method = summation::plain)
+{
+    static_assert(is_contiguous_v<State>, "combine_range requires contiguous states");
+    detail::combine_tiles<false>(y, weights, inputs, count, first, last, method);
+}
+
+/// Weighted sum y = weights[0]*inputs[0] + ... + weights[count-1]*inputs[count-1],
+/// through operations<State>::combine.  For contiguous states the sum is
+/// fused: every input is read and y is written exactly once per element, with
+/// the partial sums kept in the wider of the state and weight value types, so
+/// float states combined with double weights are summed in double.  Other
+/// states fall back to one operator pass per input, in which case the
+/// summation method is ignored.  count must be positive.
+template <class State, class Weight>
+void combine(State& y, Weight const* weights, State const* const* inputs, std::size_t count,
+             summation method = summation::plain)
+{
+    operations<State>::combine(y, weights, inputs, count, method);
+}
+
+/// Weighted update y += weights[0]*inputs[0] + ... + weights[count-1]*inputs[count-1],
+/// through operations<State>::accumulate and fused like combine() for
+/// contiguous states.  Each element is updated by adding the inputs to it one
+/// at a time, in order.
+template <class State, class Weight>
+void accumulate(State& y, Weight const* weights, State const* const* inputs, std::size_t count,
+                summation method = summation::plain)
+{
+    operations<State>::accumulate(y, weights, inputs, count, method);
+}
+
+} // namespace algebra
+} // namespace odex
+
+#endif // ODEX_ALGEBRA_COMBINE_HPP
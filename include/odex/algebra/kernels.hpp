@@ -0,0 +1,241 @@
+#ifndef ODEX_ALGEBRA_KERNELS_HPP
+#define ODEX_ALGEBRA_KERNELS_HPP
+
+#include "odex/algebra/state_traits.hpp"
+#include <type_traits>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+#include <cmath>
+
+namespace odex {
+namespace algebra {
+
+/// Number of elements combined per tile by the contiguous kernel.  The tile
+/// length is a compile-time constant so that the partial sums stay in
+/// vector registers while the inputs stream past.
+constexpr std::size_t combine_tile_size = 16;
+
+/// Distance in bytes ahead of the current tile at which the contiguous
+/// kernel prefetches each input.  Every input is a stream of its own, more
+/// than the hardware prefetchers follow for the combinations of high order
+/// schemes, so without it each tile waits on memory.
+constexpr std::size_t combine_prefetch_distance = 2048;
+
+/// Number of inputs the contiguous kernel combines in one pass.  Longer
+/// combinations are added up in several passes, rounding the sum to the
+/// value type of the state in between.
+constexpr std::size_t combine_batch_size = 32;
+
+/// Summation used by the contiguous kernels.
+///  - plain: the weighted inputs are added one after the other
+///  - compensated: Neumaier summation carries the rounding error of every
+///    addition in a second partial sum, so that the large alternating
+///    extrapolation weights of high order schemes do not cancel away the
+///    low bits of the result
+enum class summation
+{
+    plain,
+    compensated
+};
+
+namespace detail {
+
+/// Prefetches the cache lines holding Length elements starting at data.
+template <std::size_t Length, class Value>
+inline void prefetch_tile(Value const* data)
+{
+#if defined(__GNUC__)
+    constexpr std::size_t line = std::max<std::size_t>(64/sizeof(Value), 1);
+    for (std::size_t ii = 0; ii < Length; ii += line)
+    {
+        __builtin_prefetch(data+ii);
+    }
+#else
+    (void)data;
+#endif
+}
+
+/// Combines Length elements of contiguous data starting at first, keeping
+/// the partial sums in the wider of the value and weight types.  With
+/// Accumulate the sum starts from the current value of y instead of zero.
+/// With prefetch each input is prefetched combine_prefetch_distance ahead.
+template <std::size_t Length, bool Accumulate, bool Compensated, class Value, class Weight>
+inline void combine_tile(Value* y, Weight const* weights, Value const* const* inputs, std::size_t count,
+                         std::size_t first, bool prefetch)
+{
+    using accumulator_type = std::common_type_t<Value, Weight>;
+    constexpr std::size_t ahead = combine_prefetch_distance/sizeof(Value);
+
+    auto* out = y+first;
+    accumulator_type acc[Length];
+    accumulator_type comp[Length];
+    std::size_t jj = 0;
+    if constexpr (Accumulate)
+    {
+        for (std::size_t ii = 0; ii < Length; ++ii)
+        {
+            acc[ii] = static_cast<accumulator_type>(out[ii]);
+            comp[ii] = 0;
+        }
+    }
+    else
+    {
+        auto const* in = inputs[0]+first;
+        auto const w0 = static_cast<accumulator_type>(weights[0]);
+        if (prefetch)
+        {
+            prefetch_tile<Length>(in+ahead);
+        }
+        for (std::size_t ii = 0; ii < Length; ++ii)
+        {
+            acc[ii] = w0*static_cast<accumulator_type>(in[ii]);
+            comp[ii] = 0;
+        }
+        jj = 1;
+    }
+    for (; jj < count; ++jj)
+    {
+        auto const* in = inputs[jj]+first;
+        auto const wj = static_cast<accumulator_type>(weights[jj]);
+        if (prefetch)
+        {
+            prefetch_tile<Length>(in+ahead);
+        }
+        for (std::size_t ii = 0; ii < Length; ++ii)
+        {
+            auto const term = wj*static_cast<accumulator_type>(in[ii]);
+            if constexpr (Compensated)
+            {
+                auto const sum = acc[ii]+term;
+                comp[ii] += std::abs(acc[ii]) >= std::abs(term) ? (acc[ii]-sum)+term : (term-sum)+acc[ii];
+                acc[ii] = sum;
+            }
+            else
+            {
+                acc[ii] += term;
+            }
+        }
+    }
+    for (std::size_t ii = 0; ii < Length; ++ii)
+    {
+        if constexpr (Compensated)
+        {
+            out[ii] = static_cast<Value>(acc[ii]+comp[ii]);
+        }
+        else
+        {
+            out[ii] = static_cast<Value>(acc[ii]);
+        }
+    }
+}
+
+/// Runs combine_tile over the elements [first, last) of contiguous data,
+/// prefetching while the prefetched elements are still in range.
+template <bool Accumulate, bool Compensated, class Value, class Weight>
+void combine_tiles(Value* y, Weight const* weights, Value const* const* inputs, std::size_t count,
+                   std::size_t first, std::size_t last)
+{
+    constexpr std::size_t ahead = combine_prefetch_distance/sizeof(Value);
+    for (; first+combine_tile_size <= last; first += combine_tile_size)
+    {
+        combine_tile<combine_tile_size, Accumulate, Compensated>(y, weights, inputs, count, first,
+                                                                 first+ahead+combine_tile_size <= last);
+    }
+    for (; first < last; ++first)
+    {
+        combine_tile<1, Accumulate, Compensated>(y, weights, inputs, count, first, false);
+    }
+}
+
+/// Runs combine_tiles over the elements [first, last) of contiguous states,
+/// in passes of up to combine_batch_size inputs.  The tiles index the data
+/// of the inputs directly rather than reaching through each state, which
+/// would have the compiler vectorize across the inputs with gathers.
+template <bool Accumulate, bool Compensated, class State, class Weight>
+void combine_tiles(State& y, Weight const* weights, State const* const* inputs,
+                   std::size_t count, std::size_t first, std::size_t last)
+{
+    using traits = algebra::contiguous_traits<State>;
+    using value_type = typename traits::value_type;
+
+    value_type const* data[combine_batch_size];
+    for (std::size_t batch = 0; batch < count; batch += combine_batch_size)
+    {
+        auto const size = std::min(count-batch, combine_batch_size);
+        for (std::size_t jj = 0; jj < size; ++jj)
+        {
+            data[jj] = traits::data(*inputs[batch+jj]);
+        }
+        if (batch == 0)
+        {
+            combine_tiles<Accumulate, Compensated>(traits::data(y), weights, data, size, first, last);
+        }
+        else
+        {
+            combine_tiles<true, Compensated>(traits::data(y), weights+batch, data, size, first, last);
+        }
+    }
+}
+
+/// Runs combine_tiles with the summation selected at run time.
+template <bool Accumulate, class State, class Weight>
+void combine_tiles(State& y, Weight const* weights, State const* const* inputs,
+                   std::size_t count, std::size_t first, std::size_t last, summation method)
+{
+    if (method == summation::compensated)
+    {
+        combine_tiles<Accumulate, true>(y, weights, inputs, count, first, last);
+    }
+    else
+    {
+        combine_tiles<Accumulate, false>(y, weights, inputs, count, first, last);
+    }
+}
+
+/// Computes Length elements of y = sum_j weights[j]*inputs[j] starting at
+/// first, for a number of inputs fixed at compile time.  The elements are
+/// independent of one another, even when y is one of the inputs, which lets
+/// the compiler vectorize the tile without checking the pointers for overlap.
+template <std::size_t Length, class State, class Scalar, std::size_t... J>
+inline void scale_sum_tile(State& y, Scalar const* weights, State const* const* inputs, std::size_t first,
+                           std::index_sequence<J...>)
+{
+    using traits = algebra::contiguous_traits<State>;
+    using value_type = typename traits::value_type;
+    using accumulator_type = std::common_type_t<value_type, Scalar>;
+
+    accumulator_type const w[] = { static_cast<accumulator_type>(weights[J])... };
+    value_type const* in[] = { (traits::data(*inputs[J])+first)... };
+    auto* out = traits::data(y)+first;
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC ivdep
+#endif
+    for (std::size_t ii = 0; ii < Length; ++ii)
+    {
+        out[ii] = static_cast<value_type>((... + (w[J]*static_cast<accumulator_type>(in[J][ii]))));
+    }
+}
+
+/// Runs scale_sum_tile over all elements of y.
+template <std::size_t Count, class State, class Scalar>
+void scale_sum(State& y, Scalar const* weights, State const* const* inputs)
+{
+    auto const size = algebra::contiguous_traits<State>::size(y);
+    std::size_t first = 0;
+    for (; first+combine_tile_size <= size; first += combine_tile_size)
+    {
+        scale_sum_tile<combine_tile_size>(y, weights, inputs, first, std::make_index_sequence<Count>());
+    }
+    for (; first < size; ++first)
+    {
+        scale_sum_tile<1>(y, weights, inputs, first, std::make_index_sequence<Count>());
+    }
+}
+
+} // namespace detail
+
+} // namespace algebra
+} // namespace odex
+
+#endif // ODEX_ALGEBRA_KERNELS_HPP
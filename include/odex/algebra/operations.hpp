@@ -0,0 +1,158 @@
+#ifndef ODEX_ALGEBRA_OPERATIONS_HPP
+#define ODEX_ALGEBRA_OPERATIONS_HPP
+
+#include "odex/algebra/kernels.hpp"
+#include "odex/algebra/state_traits.hpp"
+#include <type_traits>
+#include <cstddef>
+
+namespace odex {
+namespace algebra {
+
+/// Vector space operations on states, through which the steppers and the
+/// extrapolation do all of their arithmetic on whole states.  The primary
+/// template is written with the state's own operators and scalar
+/// multiplication, which suits expression template types.  States described
+/// by contiguous_traits, which include Eigen dense matrices and arrays,
+/// std::vector, std::valarray, std::array and arithmetic scalars, use the
+/// fused tile kernels instead, and so need no operators at all.  Specialize
+/// it to route the operations of other state types, such as distributed
+/// arrays, to their own kernels.
+///
+/// In every operation y may be the very same state as an input, but must not
+/// otherwise overlap one.
+template <class State, class = void>
+struct operations
+{
+    /// y += a*x
+    template <class Scalar>
+    static void axpy(State& y, Scalar a, State const& x)
+    {
+        y += a*x;
+    }
+
+    /// y = a1*x1 + a2*x2
+    template <class Scalar>
+    static void scale_sum2(State& y, Scalar a1, State const& x1, Scalar a2, State const& x2)
+    {
+        y = a1*x1 + a2*x2;
+    }
+
+    /// y = a1*x1 + a2*x2 + a3*x3
+    template <class Scalar>
+    static void scale_sum3(State& y, Scalar a1, State const& x1, Scalar a2, State const& x2,
+                           Scalar a3, State const& x3)
+    {
+        y = a1*x1 + a2*x2 + a3*x3;
+    }
+
+    /// y = weights[0]*inputs[0] + ... + weights[count-1]*inputs[count-1], in
+    /// one operator pass per input.  The summation method is ignored.
+    template <class Weight>
+    static void combine(State& y, Weight const* weights, State const* const* inputs, std::size_t count,
+                        summation)
+    {
+        y = weights[0]*(*inputs[0]);
+        for (std::size_t jj = 1; jj < count; ++jj)
+        {
+            y += weights[jj]*(*inputs[jj]);
+        }
+    }
+
+    /// y += weights[0]*inputs[0] + ... + weights[count-1]*inputs[count-1]
+    template <class Weight>
+    static void accumulate(State& y, Weight const* weights, State const* const* inputs, std::size_t count,
+                           summation)
+    {
+        for (std::size_t jj = 0; jj < count; ++jj)
+        {
+            y += weights[jj]*(*inputs[jj]);
+        }
+    }
+};
+
+/// Operations on contiguous states, fused into one pass over the elements by
+/// the tile kernels.  A result whose size differs from that of the inputs,
+/// such as a default constructed std::vector, is first assigned from the
+/// first input, so only that first call allocates.
+template <class State>
+struct operations<State, std::enable_if_t<is_contiguous_v<State>>>
+{
+    template <class Scalar>
+    static void axpy(State& y, Scalar a, State const& x)
+    {
+        Scalar const weights[] = { Scalar(1), a };
+        State const* inputs[] = { &y, &x };
+        detail::scale_sum<2>(y, weights, inputs);
+    }
+
+    template <class Scalar>
+    static void scale_sum2(State& y, Scalar a1, State const& x1, Scalar a2, State const& x2)
+    {
+        _resize(y, x1);
+        Scalar const weights[] = { a1, a2 };
+        State const* inputs[] = { &x1, &x2 };
+        detail::scale_sum<2>(y, weights, inputs);
+    }
+
+    template <class Scalar>
+    static void scale_sum3(State& y, Scalar a1, State const& x1, Scalar a2, State const& x2,
+                           Scalar a3, State const& x3)
+    {
+        _resize(y, x1);
+        Scalar const weights[] = { a1, a2, a3 };
+        State const* inputs[] = { &x1, &x2, &x3 };
+        detail::scale_sum<3>(y, weights, inputs);
+    }
+
+    template <class Weight>
+    static void combine(State& y, Weight const* weights, State const* const* inputs, std::size_t count,
+                        summation method)
+    {
+        _resize(y, *inputs[0]);
+        detail::combine_tiles<false>(y, weights, inputs, count, 0, contiguous_traits<State>::size(y), method);
+    }
+
+    template <class Weight>
+    static void accumulate(State& y, Weight const* weights, State const* const* inputs, std::size_t count,
+                           summation method)
+    {
+        detail::combine_tiles<true>(y, weights, inputs, count, 0, contiguous_traits<State>::size(y), method);
+    }
+
+private:
+    /// Size y like x, unless it already is.
+    static void _resize(State& y, State const& x)
+    {
+        if (contiguous_traits<State>::size(y) != contiguous_traits<State>::size(x))
+        {
+            y = x;
+        }
+    }
+};
+
+/// y += a*x
+template <class State, class Scalar>
+void axpy(State& y, Scalar a, State const& x)
+{
+    operations<State>::axpy(y, a, x);
+}
+
+/// y = a1*x1 + a2*x2
+template <class State, class Scalar>
+void scale_sum2(State& y, Scalar a1, State const& x1, Scalar a2, State const& x2)
+{
+    operations<State>::scale_sum2(y, a1, x1, a2, x2);
+}
+
+/// y = a1*x1 + a2*x2 + a3*x3
+template <class State, class Scalar>
+void scale_sum3(State& y, Scalar a1, State const& x1, Scalar a2, State const& x2, Scalar a3, State const& x3)
+{
+    operations<State>::scale_sum3(y, a1, x1, a2, x2, a3, x3);
+}
+
+} // namespace algebra
+} // namespace odex
+
+#endif // ODEX_ALGEBRA_OPERATIONS_HPP
@@ -0,0 +1,88 @@
+
+#ifndef ODEX_ALGEBRA_STATE_TRAITS_HPP
+#define ODEX_ALGEBRA_STATE_TRAITS_HPP
+
+#include <type_traits>
+#include <cstddef>
+#include <utility>
+#include <valarray>
+#include <array>
+
+namespace odex {
+namespace algebra {
+
+/// Describes states whose elements form one contiguous array of arithmetic
+/// values, so that kernels can work on raw pointers instead of going through
+/// the state's operators.  value is false for other states.  The primary
+/// template detects data() and size() members, which covers Eigen dense
+/// matrices and arrays, std::vector and std::array; std::valarray is covered
+/// by its own specialization, and arithmetic scalars are treated as arrays of
+/// one element.  Specialize it for other state types.
+template <class State, class = void>
+struct contiguous_traits
+{
+    static constexpr bool value = false;
+};
+
+template <class State>
+struct contiguous_traits<State, std::enable_if_t<std::is_arithmetic<State>::value>>
+{
+    static constexpr bool value = true;
+    using value_type = State;
+
+    static value_type* data(State& state) { return &state; }
+    static value_type const* data(State const& state) { return &state; }
+    static std::size_t size(State const&) { return 1; }
+};
+
+template <class State>
+struct contiguous_traits<State, std::enable_if_t<
+    std::is_pointer<decltype(std::declval<State&>().data())>::value &&
+    std::is_arithmetic<std::remove_pointer_t<decltype(std::declval<State&>().data())>>::value &&
+    std::is_integral<decltype(std::declval<State const&>().size())>::value>>
+{
+    static constexpr bool value = true;
+    using value_type = std::remove_pointer_t<decltype(std::declval<State&>().data())>;
+
+    static value_type* data(State& state) { return state.data(); }
+    static value_type const* data(State const& state) { return state.data(); }
+    static std::size_t size(State const& state) { return static_cast<std::size_t>(state.size()); }
+};
+
+template <class T>
+struct contiguous_traits<std::valarray<T>, std::enable_if_t<std::is_arithmetic<T>::value>>
+{
+    static constexpr bool value = true;
+    using value_type = T;
+
+    static value_type* data(std::valarray<T>& state) { return std::begin(state); }
+    static value_type const* data(std::valarray<T> const& state) { return std::begin(state); }
+    static std::size_t size(std::valarray<T> const& state) { return state.size(); }
+};
+
+/// True if State is described by contiguous_traits.
+template <class State>
+constexpr bool is_contiguous_v = contiguous_traits<State>::value;
+
+/// True for states that keep their elements inside the object itself, so
+/// that wherever the state is placed its elements go with it.  This covers
+/// arithmetic scalars, std::array of such elements, and types with a positive
+/// SizeAtCompileTime, such as fixed size Eigen matrices and arrays.
+/// Specialize it for other state types.
+template <class State, class = void>
+struct is_inline : std::is_arithmetic<State> {};
+
+template <class T, std::size_t N>
+struct is_inline<std::array<T, N>> : is_inline<T> {};
+
+template <class State>
+struct is_inline<State, std::enable_if_t<(State::SizeAtCompileTime > 0)>> : std::true_type {};
+
+/// True if State is described by is_inline.
+template <class State>
+constexpr bool is_inline_v = is_inline<State>::value;
+
+} // namespace algebra
+} // namespace odex
+
+#endif // ODEX_ALGEBRA_STATE_TRAITS_HPP
@@ -0,0 +1,154 @@
+#ifndef ODEX_DETAIL_LINEARLY_IMPLICIT_HPP
+#define ODEX_DETAIL_LINEARLY_IMPLICIT_HPP
+
+#include "odex/detail/system_traits.hpp"
+#include "odex/algebra/combine.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+#include <array>
+
+namespace odex {
+namespace detail {
+
+/// Factorizations of I - h*A for each step count of an extrapolation scheme,
+/// all made from one matrix A, such as a Jacobian or the linear operator of
+/// a split system.  The owner fills A and marks the factorizations out of
+/// date while no sequence steps; each sequence's thread then refactors its
+/// own once and reuses it for all of its substeps.
+template <class Matrix>
+class factorization_cache
+{
+public:
+    factorization_cache()
+    : m_matrix()
+    , m_epoch(0)
+    , m_factorizations()
+    {    }
+
+    /// The matrix A.  Must only be written while no sequence steps.
+    Matrix& matrix()
+    {
+        return m_matrix;
+    }
+
+    Matrix const& matrix() const
+    {
+        return m_matrix;
+    }
+
+    /// Number of times the factorizations were marked out of date.
+    std::size_t epoch() const
+    {
+        return m_epoch;
+    }
+
+    /// Mark every factorization out of date, making room for one per step
+    /// count.  Storage is only allocated on the first call.
+    void invalidate(std::vector<std::size_t> const& step_counts)
+    {
+        ++m_epoch;
+        if (m_factorizations.size() != step_counts.size())
+        {
+            m_factorizations.resize(step_counts.size());
+            for (std::size_t ii = 0; ii < step_counts.size(); ++ii)
+            {
+                m_factorizations[ii].n = step_counts[ii];
+            }
+        }
+    }
+
+    /// Factorization of I - h*A for n substeps of h, refactoring it unless it
+    /// is up to date.  Only the thread running the sequence with n substeps
+    /// touches it.
+    template <class Time>
+    Matrix const& factor(std::size_t n, Time h) const
+    {
+        auto iter = std::find_if(m_factorizations.begin(), m_factorizations.end(), [n](factorization const& f)
+        {
+            return f.n == n;
+        });
+        assert(iter != m_factorizations.end() && "step count not passed to prepare()!");
+        if (iter->epoch != m_epoch)
+        {
+            iter->lu.factor(m_matrix, h);
+            iter->epoch = m_epoch;
+        }
+        return iter->lu;
+    }
+
+private:
+    /// Factorization of I - h*A for n substeps of h, made at epoch.
+    struct factorization
+    {
+        std::size_t n = 0;
+        std::size_t epoch = 0;
+        Matrix lu;
+    };
+
+    /// the matrix A
+    Matrix m_matrix;
+
+    /// number of invalidations, marking factorizations out of date
+    std::size_t m_epoch;
+
+    /// factorization for each step count, refactored by the sequence's thread
+    mutable std::vector<factorization> m_factorizations;
+};
+
+/// Linearly implicit midpoint steps of Bader and Deuflhard, with a matrix A
+/// treated implicitly.  With h the substep:
+///     D_0 = (I - h*A)^{-1} h*g(y_0),                    y_1 = y_0 + D_0
+///     D_k = D_{k-1} + 2*(I - h*A)^{-1} (h*g(y_k) - D_{k-1}),  y_{k+1} = y_k + D_k
+/// and a final smoothing substep adds (I - h*A)^{-1} (h*g(y_n) - D_{n-1})
+/// to y_n, where g(y) = f(y) + B*y.  The steppers differ in how B*y is
+/// added, as add_linear(scale, y, b) computing b += scale*B*y, and in how
+/// the linear systems are solved, as solve(b) overwriting b with
+/// (I - h*A)^{-1} b.  fval0 is f at y0, and the scratch holds D and the work
+/// state it is solved in.
+template <class System, class State, class Time, class Subintervals, class AddLinear, class Solve>
+void linearly_implicit_step(System& system, State const& y0, State& y, Time t, Time dt, Subintervals n,
+                            State const& fval0, std::array<State, 2>& scratch, AddLinear&& add_linear,
+                            Solve&& solve)
+{
+    auto const h = dt/static_cast<Time>(n);
+    auto const steps = static_cast<std::size_t>(n);
+    auto& delta = scratch[0];
+    auto& work = scratch[1];
+    auto tn = t;
+
+    // Solve (I - h*A) work = h*g(tn, y) - delta
+    auto const increment = [&](Time time)
+    {
+        detail::evaluate(system, time, y, work);
+        add_linear(Time(1), y, work);
+        algebra::scale_sum2(work, h, work, Time(-1), delta);
+        solve(work);
+    };
+
+    // Initial linearly implicit Euler step, iterating in the output
+    State const* inputs[] = { &fval0 };
+    algebra::combine(delta, &h, inputs, 1);
+    add_linear(h, y0, delta);
+    solve(delta);
+    algebra::scale_sum2(y, Time(1), y0, Time(1), delta);
+
+    // Linearly implicit midpoint steps
+    for (std::size_t kk = 1; kk < steps; ++kk)
+    {
+        tn += h;
+        increment(tn);
+        algebra::axpy(delta, Time(2), work);
+        algebra::axpy(y, Time(1), delta);
+    }
+
+    // Smoothing step
+    increment(t+dt);
+    algebra::axpy(y, Time(1), work);
+}
+
+} // namespace detail
+} // namespace odex
+
+#endif // ODEX_DETAIL_LINEARLY_IMPLICIT_HPP
@@ -2,22 +2,146 @@
 #ifndef ODEX_DETAIL_MAKE_EXTRAP_CONFIG_HPP
 #define ODEX_DETAIL_MAKE_EXTRAP_CONFIG_HPP
 
+#include "odex/detail/stepper_traits.hpp"
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include <vector>
 #include <tuple>
 
 namespace odex {
 namespace detail {
 
+/// Extrapolation scheme for the given order and number of cores, as the
+/// normalized imaginary stability boundary, step counts and weights, for
+/// extrapolating the given base method.  The gbs schemes extrapolate
+/// steppers::gbs.  Unsmoothed schemes, for steppers::midpoint, are
+/// Aitken-Neville extrapolations whose step counts were searched for the
+/// largest stability boundary; their boundaries are normalized by the
+/// largest step count rather than by one more than it, since the midpoint
+/// rule skips the evaluation for the smoothing step.  Linearly implicit
+/// schemes, for steppers::linearly_implicit, are Aitken-Neville
+/// extrapolations of Bader and Deuflhard's step counts 2, 6, 10, 14, 22, 34.
+/// They are stable on the whole negative real axis, so they suit stiff,
+/// diffusion dominated systems; orders 4 and 6 are also stable on the whole
+/// imaginary axis and have an infinite boundary.  Implicit-explicit schemes,
+/// for steppers::imex, share the linearly implicit step counts and weights,
+/// but their stability depends on the explicitly treated part of the
+/// system, so their boundary is reported as zero.
 template <class T>
-inline auto make_extrap_config(std::size_t order, std::size_t num_cores)
+inline auto make_extrap_config(std::size_t order, std::size_t num_cores, base_method method=base_method::gbs)
 {
     float isbn = 0.0f;
     std::vector<std::size_t> step_counts;
     std::vector<long double> weights;
 
-    if (order == 8)
+    if (method == base_method::midpoint)
+    {
+        if (order == 8 && num_cores == 3)
+        {
+            isbn = 0.4244f;
+            step_counts = {
+                2, 4, 6, 8
+              };
+            weights = {
+               -1.0L/360.0L,
+                16.0L/45.0L,
+               -729.0L/280.0L,
+                1024.0L/315.0L
+              };
+        }
+        else if (order == 12 && num_cores == 4)
+        {
+            isbn = 0.2816f;
+            step_counts = {
+                2, 4, 6, 8, 10, 12
+              };
+            weights = {
+               -1.0L/302400.0L,
+                8.0L/945.0L,
+               -2187.0L/4480.0L,
+                65536.0L/14175.0L,
+               -9765625.0L/798336.0L,
+                17496.0L/1925.0L
+              };
+        }
+        else if (order == 16 && num_cores == 5)
+        {
+            isbn = 0.2928f;
+            step_counts = {
+                4, 12, 14, 16, 18, 26, 28, 30
+              };
+            weights = {
+               -2.0L/5685805125.0L,
+                78732.0L/2118025.0L,
+               -13841287201.0L/17791488000.0L,
+                68719476736.0L/14936835375.0L,
+               -282429536481.0L/33912524800.0L,
+                3937376385699289.0L/36790915392000.0L,
+               -27682574402.0L/133716825.0L,
+                120135498046875.0L/1139029219328.0L
+              };
+        }
+    }
+    else if (method == base_method::linearly_implicit || method == base_method::imex)
+    {
+        if (order == 4 && num_cores == 2)
+        {
+            isbn = std::numeric_limits<float>::infinity();
+            step_counts = {
+                2, 6
+              };
+            weights = {
+               -1.0L/8.0L,
+                9.0L/8.0L
+              };
+        }
+        else if (order == 6 && num_cores == 2)
+        {
+            isbn = std::numeric_limits<float>::infinity();
+            step_counts = {
+                2, 6, 10
+              };
+            weights = {
+                1.0L/192.0L,
+               -81.0L/128.0L,
+                625.0L/384.0L
+              };
+        }
+        else if (order == 8 && num_cores == 3)
+        {
+            isbn = 0.1874f;
+            step_counts = {
+                2, 6, 10, 14
+              };
+            weights = {
+               -1.0L/9216.0L,
+                729.0L/5120.0L,
+               -15625.0L/9216.0L,
+                117649.0L/46080.0L
+              };
+        }
+        else if (order == 12 && num_cores == 3)
+        {
+            isbn = 0.0549f;
+            step_counts = {
+                2, 6, 10, 14, 22, 34
+              };
+            weights = {
+               -1.0L/318504960.0L,
+                59049.0L/160563200.0L,
+               -9765625.0L/233570304.0L,
+                282475249.0L/796262400.0L,
+               -25937424601.0L/15606743040.0L,
+                2015993900449.0L/858370867200.0L
+              };
+        }
+        if (method == base_method::imex)
+        {
+            isbn = 0.0f;
+        }
+    }
+    else if (order == 8)
     {
         if (num_cores == 3)
         {
@@ -0,0 +1,105 @@
+#ifndef ODEX_DETAIL_STEPPER_TRAITS_HPP
+#define ODEX_DETAIL_STEPPER_TRAITS_HPP
+
+#include "odex/algebra/state_traits.hpp"
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include <vector>
+
+namespace odex {
+namespace detail {
+
+/// True if the time stepper can add its weighted result straight into an
+/// accumulator with step_accumulate(system, y0, acc, weight, first, t, dt,
+/// n, fval0, scratch), rather than only storing it with step().
+template <class Stepper, class System, class State, class Weight, class Time, class = void>
+struct accumulates : std::false_type {};
+
+template <class Stepper, class System, class State, class Weight, class Time>
+struct accumulates<Stepper, System, State, Weight, Time,
+    std::void_t<decltype(Stepper::step_accumulate(std::declval<System&>(), std::declval<State const&>(),
+                                                  std::declval<State&>(), std::declval<Weight>(), true,
+                                                  std::declval<Time>(), std::declval<Time>(), std::size_t(1),
+                                                  std::declval<State const&>(),
+                                                  std::declval<typename Stepper::scratch_type&>()))>>
+: std::true_type {};
+
+/// Base method a time stepper discretizes, which selects the weights it is
+/// extrapolated with: Gragg's smoothed midpoint rule, the explicit midpoint
+/// rule without smoothing, the linearly implicit midpoint rule, or that rule
+/// with part of the system treated explicitly.
+enum class base_method
+{
+    gbs,
+    midpoint,
+    linearly_implicit,
+    imex
+};
+
+/// Base method of the time stepper: its method member if it declares one,
+/// and base_method::gbs otherwise.
+template <class Stepper, class = void>
+struct base_method_of : std::integral_constant<base_method, base_method::gbs> {};
+
+template <class Stepper>
+struct base_method_of<Stepper, std::void_t<decltype(Stepper::method)>>
+: std::integral_constant<base_method, Stepper::method> {};
+
+/// True if the time stepper needs to see each step before its sequences
+/// run, as stepper.prepare(system, t, dt, y0, step_counts).  This is called
+/// once per step on the stepping thread, so the stepper can evaluate data
+/// shared by every sequence and partition, such as a Jacobian.
+template <class Stepper, class System, class State, class Time, class = void>
+struct prepares : std::false_type {};
+
+template <class Stepper, class System, class State, class Time>
+struct prepares<Stepper, System, State, Time,
+    std::void_t<decltype(std::declval<Stepper&>().prepare(std::declval<System&>(), std::declval<Time>(),
+                                                         std::declval<Time>(), std::declval<State const&>(),
+                                                         std::declval<std::vector<std::size_t> const&>()))>>
+: std::true_type {};
+
+/// Time type handed to the time steppers.  States made of floating point
+/// elements step in their own precision, so that a float state combined with
+/// double extrapolation weights runs its sequences entirely in float; other
+/// states step in the weight type.
+template <class State, class Weight, class = void>
+struct stepping_time
+{
+    using type = Weight;
+};
+
+template <class State, class Weight>
+struct stepping_time<State, Weight, std::enable_if_t<algebra::is_contiguous_v<State>>>
+{
+    using value_type = typename algebra::contiguous_traits<State>::value_type;
+    using type = std::conditional_t<std::is_floating_point<value_type>::value, value_type, Weight>;
+};
+
+/// Extrapolation weight type used when none is requested: double, or the
+/// element type of a contiguous floating point state if that is wider, so
+/// that long double states are not combined with double weights.
+template <class State, class = void>
+struct default_weight
+{
+    using type = double;
+};
+
+template <class State>
+struct default_weight<State, std::enable_if_t<algebra::is_contiguous_v<State>>>
+{
+    using value_type = typename algebra::contiguous_traits<State>::value_type;
+    using type = std::conditional_t<std::is_floating_point<value_type>::value,
+                                    std::common_type_t<double, value_type>, double>;
+};
+
+/// Weight if given, otherwise the default weight for State.
+template <class Weight, class State>
+using weight_t = typename std::conditional_t<std::is_void<Weight>::value,
+                                             default_weight<State>, std::common_type<Weight>>::type;
+
+} // namespace detail
+} // namespace odex
+
+#endif // ODEX_DETAIL_STEPPER_TRAITS_HPP
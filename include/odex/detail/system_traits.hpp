@@ -0,0 +1,246 @@
+
+#ifndef ODEX_DETAIL_SYSTEM_TRAITS_HPP
+#define ODEX_DETAIL_SYSTEM_TRAITS_HPP
+
+#include "odex/threading/team.hpp"
+#include "odex/algebra/operations.hpp"
+#include <type_traits>
+#include <utility>
+
+namespace odex {
+namespace detail {
+
+/// True if the system can be evaluated as system(t, y, team), splitting its
+/// own loops across the threads of a threading::team.
+template <class System, class Time, class State, class = void>
+struct accepts_team : std::false_type {};
+
+template <class System, class Time, class State>
+struct accepts_team<System, Time, State,
+    std::void_t<decltype(std::declval<System&>()(std::declval<Time>(), std::declval<State const&>(),
+                                                 std::declval<threading::team&>()))>>
+: std::true_type {};
+
+/// True if the system can be evaluated in place as system(t, y, dydt),
+/// writing the time derivative into a caller-owned state instead of
+/// returning it.
+template <class System, class Time, class State, class = void>
+struct evaluates_in_place : std::false_type {};
+
+template <class System, class Time, class State>
+struct evaluates_in_place<System, Time, State,
+    std::void_t<decltype(std::declval<System&>()(std::declval<Time>(), std::declval<State const&>(),
+                                                 std::declval<State&>()))>>
+: std::true_type {};
+
+/// True if the system can fuse its evaluation with an update, computing
+/// out = base + scale*f(t, y) as system(t, y, base, scale, out) in a single
+/// sweep, without the derivative ever being stored.
+template <class System, class Time, class State, class = void>
+struct evaluates_fused : std::false_type {};
+
+template <class System, class Time, class State>
+struct evaluates_fused<System, Time, State,
+    std::void_t<decltype(std::declval<System&>()(std::declval<Time>(), std::declval<State const&>(),
+                                                 std::declval<State const&>(), std::declval<Time>(),
+                                                 std::declval<State&>()))>>
+: std::true_type {};
+
+/// True if the system can be evaluated in place with a team, as
+/// system(t, y, dydt, team).
+template <class System, class Time, class State, class = void>
+struct accepts_team_in_place : std::false_type {};
+
+template <class System, class Time, class State>
+struct accepts_team_in_place<System, Time, State,
+    std::void_t<decltype(std::declval<System&>()(std::declval<Time>(), std::declval<State const&>(),
+                                                 std::declval<State&>(), std::declval<threading::team&>()))>>
+: std::true_type {};
+
+/// True if the system can fuse its evaluation with an update using a team,
+/// as system(t, y, base, scale, out, team).
+template <class System, class Time, class State, class = void>
+struct accepts_team_fused : std::false_type {};
+
+template <class System, class Time, class State>
+struct accepts_team_fused<System, Time, State,
+    std::void_t<decltype(std::declval<System&>()(std::declval<Time>(), std::declval<State const&>(),
+                                                 std::declval<State const&>(), std::declval<Time>(),
+                                                 std::declval<State&>(), std::declval<threading::team&>()))>>
+: std::true_type {};
+
+/// True if the system needs no state of the caller's to hold its derivative:
+/// it fuses evaluation with the update, or returns the derivative.
+template <class System, class Time, class State>
+struct evaluates_without_derivative
+: std::integral_constant<bool, evaluates_fused<System, Time, State>::value ||
+                               !evaluates_in_place<System, Time, State>::value> {};
+
+/// True if the system provides its Jacobian as system.jacobian(t, y, J),
+/// shaping and filling a matrix such as algebra::band_matrix.
+template <class System, class Time, class State, class Matrix, class = void>
+struct provides_jacobian : std::false_type {};
+
+template <class System, class Time, class State, class Matrix>
+struct provides_jacobian<System, Time, State, Matrix,
+    std::void_t<decltype(std::declval<System&>().jacobian(std::declval<Time>(), std::declval<State const&>(),
+                                                          std::declval<Matrix&>()))>>
+: std::true_type {};
+
+/// True if the system provides the constant stiff linear operator L of a
+/// split system f(t, y) = N(t, y) + L*y as system.linear_operator(L),
+/// shaping and filling a matrix such as algebra::band_matrix.
+template <class System, class Matrix, class = void>
+struct provides_linear_operator : std::false_type {};
+
+template <class System, class Matrix>
+struct provides_linear_operator<System, Matrix,
+    std::void_t<decltype(std::declval<System&>().linear_operator(std::declval<Matrix&>()))>>
+: std::true_type {};
+
+/// True if the system applies and inverts the linear operator L of a split
+/// system itself, as system.apply_linear(y, base, scale, out), computing
+/// out = base + scale*L*y where out may be base, and system.solve_linear(h,
+/// b), overwriting b with the solution x of (I - h*L) x = b.
+template <class System, class Time, class State, class = void>
+struct solves_linear : std::false_type {};
+
+template <class System, class Time, class State>
+struct solves_linear<System, Time, State,
+    std::void_t<decltype(std::declval<System&>().apply_linear(std::declval<State const&>(), std::declval<State const&>(),
+                                                              std::declval<Time>(), std::declval<State&>())),
+                decltype(std::declval<System&>().solve_linear(std::declval<Time>(), std::declval<State&>()))>>
+: std::true_type {};
+
+/// Evaluate the time derivative of y into dydt, in place if the system
+/// supports it and by assigning its result otherwise.
+template <class System, class Time, class State>
+void evaluate(System& system, Time t, State const& y, State& dydt)
+{
+    if constexpr (evaluates_in_place<System, Time, State>::value)
+    {
+        system(t, y, dydt);
+    }
+    else
+    {
+        dydt = system(t, y);
+    }
+}
+
+/// Leap frog step y2 = y0 + 2*h*f(tn, y1) through the richest protocol the
+/// system supports.  Systems that fuse evaluation with the update compute y2
+/// directly, systems that evaluate in place write the derivative into dydt,
+/// and systems returning a state or an expression template have their result
+/// added to y0.  y2 may be y0 and dydt may be y2, but not both at once, and
+/// dydt is only written by systems that evaluate in place without fusing.
+template <class System, class Time, class State>
+void leap(System&& system, Time tn, Time h, State const& y0, State const& y1, State& y2, State& dydt)
+{
+    using system_type = std::remove_reference_t<System>;
+    if constexpr (evaluates_fused<system_type, Time, State>::value)
+    {
+        (void)dydt;
+        system(tn, y1, y0, Time(2)*h, y2);
+    }
+    else if constexpr (evaluates_in_place<system_type, Time, State>::value)
+    {
+        system(tn, y1, dydt);
+        algebra::scale_sum2(y2, Time(1), y0, Time(2)*h, dydt);
+    }
+    else if constexpr (std::is_same<std::decay_t<decltype(system(tn, y1))>, State>::value)
+    {
+        (void)dydt;
+        auto const& result = system(tn, y1);
+        algebra::scale_sum2(y2, Time(1), y0, Time(2)*h, result);
+    }
+    else
+    {
+        // leave expression templates returned by the system unevaluated
+        (void)dydt;
+        y2 = y0 + Time(2)*h*std::forward<System>(system)(tn, y1);
+    }
+}
+
+/// Adapter presenting a team-aware system through the plain system(t, y)
+/// interface the time steppers use.  The in-place and fused protocols are
+/// presented too whenever the system has them, handing it the team where it
+/// takes one, so that adapting a system never hides its richer protocols.
+template <class System>
+class team_system
+{
+public:
+    team_system(System& system, threading::team& team)
+    : m_system(system)
+    , m_team(team)
+    {    }
+
+    template <class Time, class State>
+    decltype(auto) operator()(Time&& t, State const& y)
+    {
+        return m_system(std::forward<Time>(t), y, m_team);
+    }
+
+    template <class Time, class State,
+              class = std::enable_if_t<accepts_team_in_place<System, Time, State>::value ||
+                                       evaluates_in_place<System, Time, State>::value>>
+    void operator()(Time t, State const& y, State& dydt)
+    {
+        if constexpr (accepts_team_in_place<System, Time, State>::value)
+        {
+            m_system(t, y, dydt, m_team);
+        }
+        else
+        {
+            m_system(t, y, dydt);
+        }
+    }
+
+    template <class Time, class State,
+              class = std::enable_if_t<accepts_team_fused<System, Time, State>::value ||
+                                       evaluates_fused<System, Time, State>::value>>
+    void operator()(Time t, State const& y, State const& base, Time scale, State& out)
+    {
+        if constexpr (accepts_team_fused<System, Time, State>::value)
+        {
+            m_system(t, y, base, scale, out, m_team);
+        }
+        else
+        {
+            m_system(t, y, base, scale, out);
+        }
+    }
+
+    /// The adapted system, for protocols other than evaluation.
+    System& system()
+    {
+        return m_system;
+    }
+
+private:
+    System& m_system;
+    threading::team& m_team;
+};
+
+/// Type of the system the time steppers are handed: the team_system adapter
+/// for systems that accept a team, and the system itself otherwise.
+template <class System, class Time, class State>
+using stepped_system_t = std::conditional_t<accepts_team<System, Time, State>::value, team_system<System>, System>;
+
+/// The system the time steppers were handed, seen through any team_system
+/// adapter.
+template <class System>
+System& underlying_system(System& system)
+{
+    return system;
+}
+
+template <class System>
+System& underlying_system(team_system<System>& system)
+{
+    return system.system();
+}
+
+} // namespace detail
+} // namespace odex
+
+#endif // ODEX_DETAIL_SYSTEM_TRAITS_HPP
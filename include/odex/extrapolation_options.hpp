@@ -0,0 +1,134 @@
+
+#ifndef ODEX_EXTRAPOLATION_OPTIONS_HPP
+#define ODEX_EXTRAPOLATION_OPTIONS_HPP
+
+#include "odex/threading/wait_policy.hpp"
+#include "odex/threading/affinity.hpp"
+#include "odex/threading/executor.hpp"
+#include "odex/algebra/combine.hpp"
+#include "odex/memory/arena.hpp"
+#include <cstddef>
+#include <memory>
+
+namespace odex {
+
+/// How the time steppers of an extrapolation scheme are assigned to threads.
+///  - static_partition: each thread runs a fixed bin of steppers computed once
+///    by detail::partition, assuming work proportional to the step count
+///  - dynamic: steppers are queued longest first and each thread takes the
+///    next remaining one as soon as it is idle, which absorbs state dependent
+///    system costs and noisy neighbors at the price of one atomic per stepper
+enum class scheduling
+{
+    static_partition,
+    dynamic
+};
+
+/// When the outputs of the time steppers are combined into the result.
+///  - deferred: the outputs are combined once every partition has finished
+///  - streaming: each partition's weighted outputs are folded into an
+///    accumulator as soon as the partition finishes, overlapping the
+///    combination with the slower partitions.  Partitions are folded in a
+///    fixed order, lightest first, so that the ones finishing early are
+///    folded while the heaviest still run; whichever finishes first, the
+///    results are reproducible, though they may differ from deferred
+///    combination in the last bits.
+///    Applies to parallel steppers with static scheduling only.
+///  - accumulated: each partition adds its weighted outputs into a single
+///    partition-local sum as its steppers finish, and the sums are added up
+///    at the end of the step.  The steppers' outputs are never stored, so
+///    output memory drops from one state per stepper to one per partition,
+///    as long as the stepper can add its result to the sum by itself.  Each
+///    partition of several steppers needs a second state to step into
+///    otherwise, which is the case for compact_gbs and midpoint with systems
+///    that evaluate in place without fusing, and for linearly_implicit and
+///    imex always.  The only stepper of a partition steps straight into the
+///    sum, so output memory never exceeds that of deferred combination.
+///    Applies to serial steppers and to static scheduling.
+enum class combination
+{
+    deferred,
+    streaming,
+    accumulated
+};
+
+/// Tuning options for the parallel execution of an extrapolation_stepper.
+/// The defaults reproduce the behavior of a stepper constructed without
+/// options, so callers only set the fields they care about.
+struct extrapolation_options
+{
+    /// How pool workers wait for each step to be dispatched, and how the
+    /// stepping thread waits for them to finish.  Spinning lowers the per-step
+    /// dispatch latency for small systems at the cost of busy cores.
+    threading::wait_policy wait = threading::wait_policy::blocking();
+
+    /// Placement of the partitions on cpus.  Entry 0 of the placement is left
+    /// to the stepping thread, which runs the first partition but is never
+    /// pinned by odex; pool workers are pinned to the following entries.
+    threading::affinity placement = threading::affinity::none();
+
+    /// Assignment of time steppers to threads.
+    odex::scheduling scheduling = odex::scheduling::static_partition;
+
+    /// Executor shared with other steppers.  When set, a parallel stepper
+    /// submits its partitions as tasks to this executor instead of creating
+    /// its own thread pool, and the wait and placement options are ignored.
+    /// threading::default_executor() provides a process-wide pool.
+    std::shared_ptr<threading::executor> executor;
+
+    /// Threads per partition available to the system itself.  A system that
+    /// can be called as system(t, y, team) receives a threading::team of this
+    /// size, the partition's own thread included, and may split its loops
+    /// with team.parallel_for().  Other systems ignore this option.
+    std::size_t team_size = 1;
+
+    /// Minimum number of state elements per thread for the extrapolation of
+    /// the time stepper outputs to be split across the partition threads.
+    /// Smaller states, and states whose elements are not one contiguous
+    /// array, are combined by the stepping thread alone.
+    std::size_t combine_grain = std::size_t(1) << 13;
+
+    /// When the time stepper outputs are combined into the result.
+    odex::combination combination = odex::combination::deferred;
+
+    /// Summation used when combining the time stepper outputs of states whose
+    /// elements are one contiguous array.  Together with a float state and
+    /// double weights, compensated summation keeps the combination from
+    /// losing the low bits of the result to the large alternating weights of
+    /// high order schemes.  Accumulated combination sums each partition in
+    /// the state's own precision, so it only compensates the final sum.
+    /// Streaming combination folds each partition into an accumulator of the
+    /// state's own type, so the result is rounded to the state's precision
+    /// after every partition, and the wider weights and the compensation only
+    /// act within a partition.
+    algebra::summation summation = algebra::summation::plain;
+
+    /// Evaluate the system at the initial state of each step once, on the
+    /// stepping thread before the partitions are dispatched, and share the
+    /// result read-only with every partition.  By default each partition
+    /// evaluates it for itself, which costs partitions-1 redundant system
+    /// evaluations per step but lets them start without waiting for one
+    /// another.  Sharing pays off for expensive systems, especially ones
+    /// that accept a threading::team to split the shared evaluation.
+    bool share_derivative = false;
+
+    /// Place the system copies, stepper scratch, derivatives and outputs of
+    /// every partition, and the accumulator of streaming combination, in one
+    /// arena reserved at construction, each partition in its own page aligned
+    /// region first touched by its own thread.  The state type must keep its
+    /// elements inline, as described by algebra::is_inline, such as fixed
+    /// size Eigen arrays or std::array, so that the whole working set of the
+    /// states lands in the arena; the stepper throws std::invalid_argument
+    /// for other states, whose elements would stay wherever their allocator
+    /// puts them.  Memory that the system or the stepper allocate for
+    /// themselves, such as the factorizations of linearly_implicit, stays on
+    /// the heap.
+    bool arena = false;
+
+    /// Pages backing the arena.
+    memory::pages pages = memory::pages::standard;
+};
+
+} // namespace odex
+
+#endif // ODEX_EXTRAPOLATION_OPTIONS_HPP
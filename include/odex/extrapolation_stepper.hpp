@@ -2,13 +2,25 @@
 #ifndef ODEX_EXTRAPOLATION_STEPPER_HPP
 #define ODEX_EXTRAPOLATION_STEPPER_HPP
 
+#include "odex/extrapolation_options.hpp"
 #include "odex/threading/pool.hpp"
+#include "odex/threading/shared_pool.hpp"
+#include "odex/threading/worker.hpp"
+#include "odex/algebra/combine.hpp"
+#include "odex/memory/arena.hpp"
 #include "odex/detail/partition.hpp"
+#include "odex/detail/system_traits.hpp"
+#include "odex/detail/stepper_traits.hpp"
 #include "odex/observers/null_observer.hpp"
+#include <algorithm>
 #include <iterator>
 #include <cstddef>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <new>
 
 namespace odex {
 
@@ -34,6 +46,7 @@ public:
     using state_type = State;
     using weight_type = Weight;
     using stepper_scratch_type = typename stepper_type::scratch_type;
+    using time_type = typename detail::stepping_time<state_type, weight_type>::type;
 
     /// Construct the extrapolation stepper object.
     /// \param stepper Time stepper object that does the actual system evaluation.
@@ -44,22 +57,47 @@ public:
     /// \param order Order of accuracy of the extrapolation scheme.
     /// \param isbn Normalized Imaginary Stability Boundary of the scheme.
     /// \param parallel Flag to distribute work across cores.
+    /// \param options Tuning options for parallel execution.
     template <class StepperType, class SystemType, class StepCountIterator, class WeightIterator>
     extrapolation_stepper(StepperType&& stepper, SystemType&& system, std::size_t num_steppers,
                           StepCountIterator step_counts, WeightIterator weights,
-                          std::size_t order, float isbn, bool parallel)
+                          std::size_t order, float isbn, bool parallel,
+                          extrapolation_options const& options = extrapolation_options())
     : m_order(order)
     , m_isbn(isbn)
     , m_stepper(std::forward<StepperType>(stepper))
+    , m_arena(nullptr)
     , m_systems()
     , m_scratch()
+    , m_derivatives()
     , m_weights(weights, weights+static_cast<std::ptrdiff_t>(num_steppers))
     , m_step_counts(step_counts, step_counts+static_cast<std::ptrdiff_t>(num_steppers))
     , m_outputs(num_steppers)
+    , m_output_ptrs(num_steppers, nullptr)
+    , m_pool_task(pool_task::evaluate)
+    , m_next_task(0)
     , m_input(nullptr)
+    , m_result(nullptr)
+    , m_combine_chunks(0)
+    , m_combine_weights(nullptr)
+    , m_combine_inputs(nullptr)
+    , m_combine_count(0)
+    , m_streaming(false)
+    , m_accumulating(options.combination == combination::accumulated &&
+                     (!parallel || options.scheduling == scheduling::static_partition))
+    , m_accumulator(nullptr)
+    , m_partition_done()
+    , m_fold_next(0)
+    , m_folding(false)
     , m_t(0)
     , m_dt(0)
+    , m_options(options)
     , m_pool(nullptr)
+    , m_executor(nullptr)
+    , m_teams()
+    , m_async_state(nullptr)
+    , m_async_task()
+    , m_async_worker(nullptr)
     {
         if (parallel)
         {
@@ -67,8 +105,55 @@ public:
         }
         else
         {
-            m_systems.emplace_back(std::forward<SystemType>(system));
-            m_scratch.emplace_back(stepper_scratch_type());
+            // a single partition holding every time stepper
+            m_partitions.emplace_back(m_step_counts);
+            m_partition_indices.emplace_back(num_steppers);
+            for (std::size_t jj = 0; jj < num_steppers; ++jj)
+            {
+                m_partition_indices[0][jj] = jj;
+            }
+            m_systems.resize(1);
+            m_scratch.resize(1);
+            m_derivatives.resize(1);
+            m_sums.resize(1);
+            m_sum_outputs.resize(1);
+            _initialize_arena();
+            m_systems[0] = _make<system_type>(0, std::forward<SystemType>(system));
+            _allocate_partition(0);
+        }
+
+        if constexpr (detail::accepts_team<system_type, time_type, state_type>::value)
+        {
+            _initialize_teams();
+        }
+
+        // inputs of the combination at the end of each step: either every
+        // stepper's output, or the partition sums of the accumulated mode
+        if (m_accumulating)
+        {
+            for (std::size_t index = 0; index < m_sums.size(); ++index)
+            {
+                if (m_sums[index])
+                {
+                    // a single stepper's output is weighted when combined
+                    auto const& inds = m_partition_indices[index];
+                    m_sum_ptrs.push_back(m_sums[index].get());
+                    m_sum_weights.push_back(inds.size() == 1 ? m_weights[inds[0]] : weight_type(1));
+                }
+            }
+            m_combine_weights = m_sum_weights.data();
+            m_combine_inputs = m_sum_ptrs.data();
+            m_combine_count = m_sum_ptrs.size();
+        }
+        else
+        {
+            for (std::size_t jj = 0; jj < num_steppers; ++jj)
+            {
+                m_output_ptrs[jj] = m_outputs[jj].get();
+            }
+            m_combine_weights = m_weights.data();
+            m_combine_inputs = m_output_ptrs.data();
+            m_combine_count = num_steppers;
         }
     }
 
@@ -78,12 +163,27 @@ public:
         return m_order;
     }
 
-    /// Normalized Imaginary Stability Boundary of the scheme
+    /// Normalized Imaginary Stability Boundary of the scheme, or zero if the
+    /// scheme has none, such as an implicit-explicit one
     float isbn() const
     {
         return m_isbn;
     }
 
+    /// Bytes reserved by the arena holding the buffers of every partition,
+    /// fixed at construction, or zero if the buffers are on the heap.
+    std::size_t arena_size() const
+    {
+        return m_arena ? m_arena->size() : 0;
+    }
+
+    /// Start of the arena holding the buffers of every partition, or null if
+    /// the buffers are on the heap.
+    unsigned char const* arena_data() const
+    {
+        return m_arena ? m_arena->data() : nullptr;
+    }
+
     /// Step the system n time steps without observation.
     /// \param y Input/output state.
     /// \param t Initial time for system evaluation.
@@ -95,7 +195,10 @@ public:
         step(y, t, dt, n, observers::null_observer{});
     }
 
-    /// Step the system a n time steps, observing each output.
+    /// Step the system a n time steps, observing each output.  Buffers are
+    /// sized on the first step; after that, stepping makes no heap
+    /// allocations of its own, so the loop is allocation free whenever the
+    /// system, the observer and the state's operators are.
     /// \param y Input/output state.
     /// \param t Initial time for system evaluation.
     /// \param dt Time step size.
@@ -104,10 +207,6 @@ public:
     template <class Time, class NumSteps, class Observer>
     void step(state_type& y, Time t, Time dt, NumSteps n, Observer&& observer)
     {
-        auto const nsteppers = m_step_counts.size();
-        auto const& weights = m_weights;
-        auto const& outputs = m_outputs;
-
         for (std::size_t ii = 0; ii < n; ++ii)
         {
             // Run the individual steppers.  This should be done depending on
@@ -116,11 +215,7 @@ public:
 
             // Extrapolate the results from the individual steppers to get the
             // high-order-accurate result with desired stability domain.
-            y = weights[0]*outputs[0];
-            for (std::size_t jj = 1; jj < nsteppers; ++jj)
-            {
-                y += weights[jj]*outputs[jj];
-            }
+            _combine(y);
 
             // Send the result to the observer
             std::forward<Observer>(observer)(t, y);
@@ -130,15 +225,94 @@ public:
         }
     }
 
+    /// Start stepping the system n time steps without observation, returning
+    /// immediately.  See the observing overload for details.
+    template <class Time, class NumSteps>
+    std::future<void> step_async(state_type& y, Time t, Time dt, NumSteps n)
+    {
+        return step_async(y, t, dt, n, observers::null_observer{});
+    }
+
+    /// Start stepping the system n time steps on a background thread, returning
+    /// a future that becomes ready once y holds the result.  The steps run on
+    /// a private copy of y, so y is only read at the start and written once at
+    /// the end: until the future is ready the caller may keep reading y, but
+    /// must not write it.  The observer is copied and is called on the
+    /// background thread.  Only one step or step_async may be in flight at a
+    /// time, and the stepper must outlive the returned future's completion.
+    /// \param y Input/output state.
+    /// \param t Initial time for system evaluation.
+    /// \param dt Time step size.
+    /// \param n Number of time steps.
+    /// \param observer Callable observer object to record each time step.
+    template <class Time, class NumSteps, class Observer>
+    std::future<void> step_async(state_type& y, Time t, Time dt, NumSteps n, Observer&& observer)
+    {
+        if (!m_async_worker)
+        {
+            m_async_state.reset(new state_type());
+            m_async_worker.reset(new threading::worker([this]
+            {
+                // take the task before running it, since the caller may
+                // hand over the next one as soon as this one's future is
+                // ready, which is before the task has returned
+                auto task = std::move(m_async_task);
+                task();
+            }));
+        }
+
+        auto task = [this, &y, t, dt, n, observer = std::forward<Observer>(observer)]() mutable
+        {
+            auto& state = *m_async_state;
+            state = y;
+            step(state, t, dt, n, observer);
+            y = state;
+        };
+        m_async_task = std::packaged_task<void()>(std::move(task));
+        auto result = m_async_task.get_future();
+        m_async_worker->notify();
+        return result;
+    }
+
 private:
+    /// True if the time stepper sums its weighted output into a state by
+    /// itself, stepping the system as the steppers are handed it.
+    static constexpr bool stepper_accumulates =
+        detail::accumulates<stepper_type, detail::stepped_system_t<system_type, time_type, state_type>,
+                            state_type, weight_type, time_type>::value;
+
+    /// Work run by the pool workers on each dispatch.
+    enum class pool_task
+    {
+        allocate,
+        evaluate,
+        combine
+    };
+
     /// Dispatch the actual time stepper evaluation code.
     template <class Time>
     void _evaluate(state_type const& y, Time t, Time dt)
     {
         m_input = &y;
-        m_t = t;
-        m_dt = dt;
-        if (m_pool)
+        m_t = static_cast<time_type>(t);
+        m_dt = static_cast<time_type>(dt);
+        if (m_streaming)
+        {
+            _reset_folds();
+        }
+        if (_sharing_derivative())
+        {
+            _evaluate_derivative();
+        }
+        if constexpr (detail::prepares<stepper_type, system_type, state_type, time_type>::value)
+        {
+            m_stepper.prepare(*m_systems[0], m_t, m_dt, y, m_step_counts);
+        }
+        if (m_executor)
+        {
+            _evaluate_shared();
+        }
+        else if (m_pool)
         {
             _evaluate_parallel();
         }
@@ -148,32 +322,463 @@ private:
         }
     }
 
-    /// Run the time steppers all on a single core.
+    /// Whether the partitions share one derivative at the initial state, which
+    /// only matters when there is more than one partition.
+    bool _sharing_derivative() const
+    {
+        return m_options.share_derivative && m_partitions.size() > 1;
+    }
+
+    /// Evaluate the system at the initial state once for every partition,
+    /// on the stepping thread and with the first partition's system.  Systems
+    /// that accept a threading::team split the evaluation across its team.
+    void _evaluate_derivative()
+    {
+        if constexpr (detail::accepts_team<system_type, time_type, state_type>::value)
+        {
+            detail::team_system<system_type> current_system(*m_systems[0], *m_teams[0]);
+            detail::evaluate(current_system, m_t, *m_input, *m_derivatives[0]);
+        }
+        else
+        {
+            detail::evaluate(*m_systems[0], m_t, *m_input, *m_derivatives[0]);
+        }
+    }
+
+    /// Derivative at the initial state used by the partition at index,
+    /// evaluating it first unless it is shared and has been evaluated
+    /// already.
+    template <class SystemType>
+    state_type const& _derivative(std::size_t index, SystemType& current_system)
+    {
+        if (_sharing_derivative())
+        {
+            return *m_derivatives[0];
+        }
+        auto& fval0 = *m_derivatives[index];
+        detail::evaluate(current_system, m_t, *m_input, fval0);
+        return fval0;
+    }
+
+    /// Run the time steppers all on a single core.  In serial mode there is
+    /// exactly one partition that contains every time stepper.
     void _evaluate_serial()
     {
-        // get references to data members
-        auto& system = m_systems[0];
+        _evaluate_partition(0);
+    }
+    
+    /// Run the time steppers in parallel across cores.  The calling thread
+    /// evaluates the first partition while the pool workers run the rest.
+    void _evaluate_parallel()
+    {
+        m_pool_task = pool_task::evaluate;
+        m_next_task.store(0, std::memory_order_relaxed);
+        m_pool->process([this]{ _evaluate_partition(0); });
+    }
+
+    /// Run the time steppers on a shared executor, one task per partition.
+    void _evaluate_shared()
+    {
+        m_next_task.store(0, std::memory_order_relaxed);
+        auto task = [this](std::size_t index)
+        {
+            _evaluate_partition(index);
+        };
+        m_executor->bulk_run(m_partitions.size(), task);
+    }
+
+    /// Run the time steppers assigned to the partition at index.  Systems
+    /// that accept a threading::team are handed the partition's team.
+    void _evaluate_partition(std::size_t index)
+    {
+        if constexpr (detail::accepts_team<system_type, time_type, state_type>::value)
+        {
+            detail::team_system<system_type> current_system(*m_systems[index], *m_teams[index]);
+            _evaluate_partition(index, current_system);
+        }
+        else
+        {
+            _evaluate_partition(index, *m_systems[index]);
+        }
+    }
+
+    /// Run the time steppers assigned to the partition at index, evaluating
+    /// the given system.
+    template <class SystemType>
+    void _evaluate_partition(std::size_t index, SystemType& current_system)
+    {
+        if (!m_task_order.empty() && m_options.scheduling == scheduling::dynamic)
+        {
+            _evaluate_dynamic(index, current_system);
+            return;
+        }
+
+        // get the partition-local indices
+        auto const& inds = m_partition_indices[index];
+
+        // get local references to data members
         auto const& input = *m_input;
         auto& outputs = m_outputs;
         auto const t = m_t;
         auto const dt = m_dt;
         auto const& step_counts = m_step_counts;
-        auto& scratch = m_scratch[0];
+        auto& scratch = *m_scratch[index];
 
-        // evaluate the system to share with all steppers
-        auto fval0 = system(t, input);
+        // evaluate the system to share with all steppers on this core
+        auto const& fval0 = _derivative(index, current_system);
 
-        // run the individual time steppers
-        for (std::size_t jj = 0, nsteppers = m_step_counts.size(); jj < nsteppers; ++jj)
+        // run each of the steppers on this core
+        for (std::size_t jj = 0; jj < inds.size(); ++jj)
         {
-            m_stepper.step(system, input, outputs[jj], t, dt, step_counts[jj], fval0, scratch);
+            auto ind = inds[jj];
+            if (m_accumulating)
+            {
+                _step_accumulate(current_system, index, ind, jj == 0, fval0);
+            }
+            else
+            {
+                m_stepper.step(current_system, input, *outputs[ind], t, dt, step_counts[ind], fval0, scratch);
+            }
+        }
+
+        if (m_streaming)
+        {
+            _fold_partition(index);
         }
     }
-    
-    /// Run the time steppers in parallel across cores.
-    void _evaluate_parallel()
+
+    /// Run the time stepper at ind, adding its weighted result into the sum
+    /// of the partition at index, or starting the sum if first is set.
+    /// Steppers without step_accumulate() step into a partition-local output
+    /// that is then added to the sum.  The only stepper of a partition steps
+    /// straight into the sum, which is weighted when the sums are combined.
+    template <class SystemType>
+    void _step_accumulate(SystemType& current_system, std::size_t index, std::size_t ind, bool first,
+                          state_type const& fval0)
     {
-        m_pool->process();
+        auto const& input = *m_input;
+        auto& sum = *m_sums[index];
+        auto& scratch = *m_scratch[index];
+        auto const weight = m_weights[ind];
+        auto const n = m_step_counts[ind];
+
+        if (m_partition_indices[index].size() == 1)
+        {
+            m_stepper.step(current_system, input, sum, m_t, m_dt, n, fval0, scratch);
+        }
+        else if constexpr (detail::accumulates<stepper_type, SystemType, state_type, weight_type, time_type>::value)
+        {
+            m_stepper.step_accumulate(current_system, input, sum, weight, first, m_t, m_dt, n,
+                                      fval0, scratch);
+        }
+        else
+        {
+            auto& output = *m_sum_outputs[index];
+            m_stepper.step(current_system, input, output, m_t, m_dt, n, fval0, scratch);
+            state_type const* outputs[] = { &output };
+            if (first)
+            {
+                algebra::combine(sum, &weight, outputs, 1);
+            }
+            else
+            {
+                algebra::accumulate(sum, &weight, outputs, 1);
+            }
+        }
+    }
+
+    /// Run time steppers from the shared longest-first queue until it is
+    /// empty.  The system is only evaluated at the initial state once this
+    /// thread has claimed its first stepper.
+    template <class SystemType>
+    void _evaluate_dynamic(std::size_t index, SystemType& current_system)
+    {
+        auto const& order = m_task_order;
+        auto task = m_next_task.fetch_add(1, std::memory_order_relaxed);
+        if (task >= order.size())
+        {
+            return;
+        }
+
+        // get local references to data members
+        auto const& input = *m_input;
+        auto& outputs = m_outputs;
+        auto const t = m_t;
+        auto const dt = m_dt;
+        auto const& step_counts = m_step_counts;
+        auto& scratch = *m_scratch[index];
+
+        // evaluate the system to share with all steppers run by this thread
+        auto const& fval0 = _derivative(index, current_system);
+
+        // run steppers until the queue is drained
+        do
+        {
+            auto ind = order[task];
+            m_stepper.step(current_system, input, *outputs[ind], t, dt, step_counts[ind], fval0, scratch);
+            task = m_next_task.fetch_add(1, std::memory_order_relaxed);
+        }
+        while (task < order.size());
+    }
+
+    /// Extrapolate the time stepper outputs into y.  Once every partition has
+    /// finished, contiguous states large enough to amortize a second dispatch
+    /// are split into index ranges that the partition threads combine in
+    /// parallel; the fold order of each element is the same either way.
+    void _combine(state_type& y)
+    {
+        if (m_streaming)
+        {
+            // every partition has finished, so no other thread is folding
+            _fold_ready();
+            y = *m_accumulator;
+            return;
+        }
+
+        if constexpr (algebra::is_contiguous_v<state_type>)
+        {
+            auto const size = algebra::contiguous_traits<state_type>::size(y);
+            auto const grain = std::max<std::size_t>(m_options.combine_grain, 1);
+            m_combine_chunks = std::min(m_partitions.size(), size/grain);
+            if (m_combine_chunks > 1 && (m_pool || m_executor))
+            {
+                m_result = &y;
+                if (m_executor)
+                {
+                    auto task = [this](std::size_t index)
+                    {
+                        _combine_partition(index);
+                    };
+                    m_executor->bulk_run(m_combine_chunks, task);
+                }
+                else
+                {
+                    m_pool_task = pool_task::combine;
+                    m_pool->process([this]{ _combine_partition(0); });
+                }
+                return;
+            }
+        }
+        algebra::combine(y, m_combine_weights, m_combine_inputs, m_combine_count, m_options.summation);
+    }
+
+    /// Combine the index range of the result assigned to the partition at
+    /// index.  Ranges are whole combination tiles, so neighboring threads
+    /// only share the cache lines at range boundaries.
+    void _combine_partition(std::size_t index)
+    {
+        if constexpr (algebra::is_contiguous_v<state_type>)
+        {
+            auto const chunks = m_combine_chunks;
+            if (index >= chunks)
+            {
+                return;
+            }
+
+            auto& y = *m_result;
+            auto const size = algebra::contiguous_traits<state_type>::size(y);
+            auto const tile = algebra::combine_tile_size;
+            auto const tiles = (size+tile-1)/tile;
+            auto const first = std::min(size, tiles*index/chunks*tile);
+            auto const last = std::min(size, tiles*(index+1)/chunks*tile);
+            algebra::combine_range(y, m_combine_weights, m_combine_inputs, m_combine_count, first, last, m_options.summation);
+        }
+    }
+
+    /// Prepare the streaming combination for a new step.
+    void _reset_folds()
+    {
+        for (std::size_t ii = 0; ii < m_partitions.size(); ++ii)
+        {
+            m_partition_done[ii].store(false, std::memory_order_relaxed);
+        }
+        m_fold_next.store(0, std::memory_order_relaxed);
+    }
+
+    /// Mark the partition at index finished, then fold every finished
+    /// partition next in line into the accumulator unless another thread is
+    /// already folding.  The folding thread checks again after letting go,
+    /// so a partition finishing while it folds is not left behind; whatever
+    /// remains is folded by the stepping thread after the barrier.
+    void _fold_partition(std::size_t index)
+    {
+        m_partition_done[index].store(true);
+        for (;;)
+        {
+            if (m_folding.exchange(true))
+            {
+                return;
+            }
+            _fold_ready();
+            m_folding.store(false);
+
+            auto const next = m_fold_next.load();
+            if (next == m_fold_order.size() || !m_partition_done[m_fold_order[next]].load())
+            {
+                return;
+            }
+        }
+    }
+
+    /// Fold the finished partitions next in line into the accumulator, in
+    /// fold order.  The first partition folded overwrites the previous step.
+    void _fold_ready()
+    {
+        auto next = m_fold_next.load(std::memory_order_relaxed);
+        while (next < m_fold_order.size() && m_partition_done[m_fold_order[next]].load(std::memory_order_acquire))
+        {
+            auto const index = m_fold_order[next];
+            auto const& weights = m_partition_weights[index];
+            auto const& outputs = m_partition_outputs[index];
+            if (next == 0)
+            {
+                algebra::combine(*m_accumulator, weights.data(), outputs.data(), outputs.size(), m_options.summation);
+            }
+            else
+            {
+                algebra::accumulate(*m_accumulator, weights.data(), outputs.data(), outputs.size(), m_options.summation);
+            }
+            ++next;
+        }
+        m_fold_next.store(next, std::memory_order_relaxed);
+    }
+
+    /// Give each partition a team of threads for the system to split its own
+    /// loops across.  Team helpers are placed after the partition threads.
+    void _initialize_teams()
+    {
+        auto const num_partitions = m_partitions.size();
+        auto const team_size = std::max<std::size_t>(m_options.team_size, 1);
+        auto const cpus = m_options.placement.cpus(num_partitions*team_size);
+        for (std::size_t ii = 0; ii < num_partitions; ++ii)
+        {
+            auto first = cpus.begin()+static_cast<std::ptrdiff_t>(num_partitions+ii*(team_size-1));
+            std::vector<int> helper_cpus(first, first+static_cast<std::ptrdiff_t>(team_size-1));
+            m_teams.emplace_back(new threading::team(team_size, m_options.wait, std::move(helper_cpus)));
+        }
+    }
+
+    /// Bytes of the arena region holding the buffers of the partition at
+    /// index.  Must agree with the objects made by _allocate_partition.
+    std::size_t _partition_bytes(std::size_t index) const
+    {
+        auto const pad = [](std::size_t bytes)
+        {
+            auto const alignment = memory::arena::alignment;
+            return (bytes+alignment-1)/alignment*alignment;
+        };
+
+        auto const num_steppers = m_partition_indices[index].size();
+        std::size_t num_states = index == 0 || !_sharing_derivative() ? 1 : 0;
+        if (index == 0 && m_streaming)
+        {
+            num_states += 1;
+        }
+        if (!m_accumulating)
+        {
+            num_states += num_steppers;
+        }
+        else if (num_steppers > 0)
+        {
+            num_states += stepper_accumulates || num_steppers == 1 ? 1 : 2;
+        }
+        return pad(sizeof(system_type))+pad(sizeof(stepper_scratch_type))+num_states*pad(sizeof(state_type));
+    }
+
+    /// Reserve one arena for the buffers of every partition, if requested.
+    /// Each partition gets its own page aligned region, so the pages of a
+    /// partition are first touched by the thread that owns it.  Throws
+    /// std::invalid_argument unless the state keeps its elements inline.
+    void _initialize_arena()
+    {
+        if (!m_options.arena)
+        {
+            return;
+        }
+        if (!algebra::is_inline_v<state_type>)
+        {
+            // the elements would stay wherever the state's allocator puts them
+            throw std::invalid_argument("arena placement requires states that keep their elements inline");
+        }
+
+        auto const page = memory::arena::page_size(m_options.pages);
+        std::size_t size = 0;
+        for (std::size_t ii = 0; ii < m_partitions.size(); ++ii)
+        {
+            m_arena_offsets.push_back(size);
+            size += (_partition_bytes(ii)+page-1)/page*page;
+            m_arena_ends.push_back(size);
+        }
+        m_arena.reset(new memory::arena(size, m_options.pages));
+    }
+
+    /// Construct an object owned by the partition at index, in the
+    /// partition's arena region if there is an arena and on the heap
+    /// otherwise.  Throws std::bad_alloc if the object would not fit in the
+    /// region, which means _partition_bytes is out of date.
+    template <class T, class... Args>
+    memory::arena_ptr<T> _make(std::size_t index, Args&&... args)
+    {
+        if (!m_arena)
+        {
+            return memory::arena_ptr<T>(new T(std::forward<Args>(args)...));
+        }
+
+        static_assert(alignof(T) <= memory::arena::alignment, "arena buffers are aligned to a cache line");
+        auto& offset = m_arena_offsets[index];
+        if (offset+sizeof(T) > m_arena_ends[index])
+        {
+            // never let a partition spill into the region of the next one
+            throw std::bad_alloc();
+        }
+        auto* ptr = new (m_arena->data()+offset) T(std::forward<Args>(args)...);
+        offset += (sizeof(T)+memory::arena::alignment-1)/memory::arena::alignment*memory::arena::alignment;
+        return memory::arena_ptr<T>(ptr, memory::arena_delete<T>{true});
+    }
+
+    /// Allocate the system copy, stepper scratch and outputs owned by the
+    /// partition at index.  This runs on the thread that evaluates the
+    /// partition, so with a first-touch NUMA policy its buffers are placed on
+    /// the memory node local to that thread.  The first copy of the system is
+    /// constructed before the workers start, and the others copy it.
+    void _allocate_partition(std::size_t index)
+    {
+        if (!m_systems[index])
+        {
+            m_systems[index] = _make<system_type>(index, *m_systems[0]);
+        }
+        m_scratch[index] = _make<stepper_scratch_type>(index);
+        if (index == 0 || !_sharing_derivative())
+        {
+            m_derivatives[index] = _make<state_type>(index);
+        }
+        if (index == 0 && m_streaming)
+        {
+            // sized like the state on the first step, unless it is inline
+            m_accumulator = _make<state_type>(index);
+        }
+        if (m_accumulating)
+        {
+            // empty partitions have nothing to sum
+            if (!m_partition_indices[index].empty())
+            {
+                m_sums[index] = _make<state_type>(index);
+                if (!stepper_accumulates && m_partition_indices[index].size() > 1)
+                {
+                    m_sum_outputs[index] = _make<state_type>(index);
+                }
+            }
+            return;
+        }
+        for (auto ind : m_partition_indices[index])
+        {
+            m_outputs[ind] = _make<state_type>(index);
+            if (m_streaming)
+            {
+                m_partition_weights[index].push_back(m_weights[ind]);
+                m_partition_outputs[index].push_back(m_outputs[ind].get());
+            }
+        }
     }
 
     /// Initialize the thread pool, dividing up the work as evenly as possible
@@ -198,44 +803,100 @@ private:
             }
         }
 
-        // target work function
-        auto target = [this](std::size_t index)
+        // queue order for dynamic scheduling: longest step count first
+        m_task_order.resize(m_step_counts.size());
+        for (std::size_t ii = 0; ii < m_task_order.size(); ++ii)
         {
-            // get the partition-local indices
-            auto const& inds = m_partition_indices[index];
+            m_task_order[ii] = ii;
+        }
+        std::stable_sort(m_task_order.begin(), m_task_order.end(), [this](std::size_t a, std::size_t b)
+        {
+            return m_step_counts[a] > m_step_counts[b];
+        });
 
-            // get local references to data members
-            auto& current_system = m_systems[index];
-            auto const& input = *m_input;
-            auto& outputs = m_outputs;
-            auto const t = m_t;
-            auto const dt = m_dt;
-            auto const& step_counts = m_step_counts;
-            auto& scratch = m_scratch[index];
+        // weights and outputs of each partition, for folding them as soon as
+        // the partition finishes.  detail::partition fills the first bins
+        // first, so the heaviest partitions come first, the stepping thread's
+        // among them.  folding the lightest first lets the partitions that
+        // finish early be folded while the heaviest ones still run
+        m_streaming = m_options.combination == combination::streaming &&
+                      m_options.scheduling == scheduling::static_partition;
+        if (m_streaming)
+        {
+            m_partition_weights.resize(num_cores);
+            m_partition_outputs.resize(num_cores);
+            m_partition_done.reset(new std::atomic<bool>[num_cores]);
 
-            // evaluate the system to share with all steppers on this core
-            auto fval0 = current_system(t, input);
+            std::vector<std::size_t> loads(num_cores, 0);
+            for (std::size_t ii = 0; ii < num_cores; ++ii)
+            {
+                for (auto count : m_partitions[ii])
+                {
+                    loads[ii] += count;
+                }
+                m_fold_order.push_back(ii);
+            }
+            std::sort(m_fold_order.begin(), m_fold_order.end(), [&loads](std::size_t a, std::size_t b)
+            {
+                // ties go to the later partition, leaving the stepping thread's last
+                return loads[a] != loads[b] ? loads[a] < loads[b] : a > b;
+            });
+        }
+
+        // the first system is built here; each partition copies it on its own thread
+        m_systems.resize(num_cores);
+        m_scratch.resize(num_cores);
+        m_derivatives.resize(num_cores);
+        m_sums.resize(num_cores);
+        m_sum_outputs.resize(num_cores);
+        _initialize_arena();
+        m_systems[0] = _make<system_type>(0, std::forward<SystemType>(system));
+
+        // a shared executor runs the partitions on whichever of its threads
+        // are free, so there are no owning threads to allocate on
+        if (m_options.executor)
+        {
+            m_executor = m_options.executor;
+            for (std::size_t ii = 0; ii < num_cores; ++ii)
+            {
+                _allocate_partition(ii);
+            }
+            return;
+        }
 
-            // run each of the steppers on this core
-            for (std::size_t jj = 0; jj < inds.size(); ++jj)
+        // target work function
+        auto target = [this](std::size_t index)
+        {
+            switch (m_pool_task)
             {
-                auto ind = inds[jj];
-                m_stepper.step(current_system, input, outputs[ind], t, dt, step_counts[ind], fval0, scratch);
+            case pool_task::allocate:
+                _allocate_partition(index);
+                break;
+            case pool_task::evaluate:
+                _evaluate_partition(index);
+                break;
+            case pool_task::combine:
+                _combine_partition(index);
+                break;
             }
         };
 
-        // instantiate the thread pool
-        m_pool.reset(new threading::pool(m_partitions.size()));
+        // instantiate the thread pool.  the calling thread evaluates the
+        // first partition itself, so the pool needs one fewer worker.  the
+        // first cpu of the placement is left to the calling thread
+        auto cpus = m_options.placement.cpus(num_cores);
+        cpus.erase(cpus.begin());
+        m_pool.reset(new threading::pool(num_cores-1, m_options.wait, cpus));
 
         // construct the workers with the target functions
-        for (std::size_t ii = 0; ii < num_cores; ++ii)
+        for (std::size_t ii = 1; ii < num_cores; ++ii)
         {
-            m_pool->emplace(ii, target, ii);
+            m_pool->emplace(ii-1, target, ii);
         }
 
-        // copy the system for each thread
-        m_systems = std::vector<system_type>(m_partitions.size(), std::forward<SystemType>(system));
-        m_scratch = std::vector<stepper_scratch_type>(m_partitions.size());
+        // allocate each partition's buffers on the thread that owns them
+        m_pool_task = pool_task::allocate;
+        m_pool->process([this]{ _allocate_partition(0); });
     }
 
 private:
@@ -246,17 +907,35 @@ private:
     float m_isbn;
 
     /// time stepping algorithm.  evaluating its step() method must not change
-    /// any of its internal state since this is run concurrently
-    stepper_type const m_stepper;
+    /// any of its internal state since this is run concurrently; only its
+    /// prepare() method, run alone on the stepping thread, may
+    stepper_type m_stepper;
+
+    /// arena holding the buffers of every partition, if requested
+    std::unique_ptr<memory::arena> m_arena;
+
+    /// next free byte of each partition's arena region
+    std::vector<std::size_t> m_arena_offsets;
+
+    /// end of each partition's arena region
+    std::vector<std::size_t> m_arena_ends;
 
     /// vector of systems to time step, one copy per core, so that evaluation
     /// can be performed concurrently without worrying about clobbering internal
     /// state.  if system evaluation is reentrant, consider wrapping this in
-    /// a std::reference_wrapper to share this read-only memory across cores
-    std::vector<system_type> m_systems;
+    /// a std::reference_wrapper to share this read-only memory across cores.
+    /// held by pointer so each copy can be constructed on its owning thread
+    std::vector<memory::arena_ptr<system_type>> m_systems;
 
     /// each core gets a copy of the scratch required by the time stepper
-    std::vector<stepper_scratch_type> m_scratch;
+    std::vector<memory::arena_ptr<stepper_scratch_type>> m_scratch;
+
+    /// time derivative at the initial state of each step, one per core.  it
+    /// is evaluated once per partition and shared by its time steppers, and
+    /// is stored rather than held as the system's returned value so that
+    /// results of lazily evaluated systems cannot change as the steppers
+    /// evaluate the system again
+    std::vector<memory::arena_ptr<state_type>> m_derivatives;
 
     /// extrapolation weights
     std::vector<weight_type> const m_weights;
@@ -264,17 +943,88 @@ private:
     /// extrapolation step count sequence
     std::vector<std::size_t> const m_step_counts;
 
-    /// pre-extrapolated outputs for each time stepper
-    std::vector<state_type> m_outputs;
+    /// pre-extrapolated outputs for each time stepper, allocated by the
+    /// thread that owns the time stepper's partition
+    std::vector<memory::arena_ptr<state_type>> m_outputs;
+
+    /// raw pointers to the outputs, in time stepper order, for the combination
+    std::vector<state_type const*> m_output_ptrs;
+
+    /// work run by the pool workers on the next dispatch
+    pool_task m_pool_task;
+
+    /// next entry of m_task_order to be claimed under dynamic scheduling
+    std::atomic<std::size_t> m_next_task;
+
+    /// time stepper indices sorted by descending step count
+    std::vector<std::size_t> m_task_order;
 
     /// pointer to the current input
     state_type const* m_input;
 
+    /// pointer to the state receiving a parallel combination
+    state_type* m_result;
+
+    /// number of index ranges the current combination is split into
+    std::size_t m_combine_chunks;
+
+    /// weights of the inputs to the combination at the end of each step
+    weight_type const* m_combine_weights;
+
+    /// inputs to the combination at the end of each step
+    state_type const* const* m_combine_inputs;
+
+    /// number of inputs to the combination at the end of each step
+    std::size_t m_combine_count;
+
+    /// flag to fold each partition's outputs as soon as it finishes
+    bool m_streaming;
+
+    /// flag to sum each partition's weighted outputs in place of storing them
+    bool const m_accumulating;
+
+    /// weighted sum of each partition's outputs under accumulated combination.
+    /// null for empty partitions
+    std::vector<memory::arena_ptr<state_type>> m_sums;
+
+    /// output of each partition's current stepper under accumulated
+    /// combination, for steppers that cannot accumulate by themselves
+    std::vector<memory::arena_ptr<state_type>> m_sum_outputs;
+
+    /// weights of the partition sums: one, or the weight of the only stepper
+    /// of the partition
+    std::vector<weight_type> m_sum_weights;
+
+    /// non-null partition sums, in partition order
+    std::vector<state_type const*> m_sum_ptrs;
+
+    /// running sum of the folded partitions under streaming combination,
+    /// owned by the stepping thread's partition
+    memory::arena_ptr<state_type> m_accumulator;
+
+    /// weights of each partition's time steppers, in partition order
+    std::vector<std::vector<weight_type>> m_partition_weights;
+
+    /// outputs of each partition's time steppers, in partition order
+    std::vector<std::vector<state_type const*>> m_partition_outputs;
+
+    /// finished flag of each partition for the current step
+    std::unique_ptr<std::atomic<bool>[]> m_partition_done;
+
+    /// partition indices in the order they are folded, by ascending load
+    std::vector<std::size_t> m_fold_order;
+
+    /// next entry of m_fold_order to be folded into the accumulator
+    std::atomic<std::size_t> m_fold_next;
+
+    /// flag held by the thread currently folding
+    std::atomic<bool> m_folding;
+
     /// current time
-    weight_type m_t;
+    time_type m_t;
 
     /// time step size
-    weight_type m_dt;
+    time_type m_dt;
 
     /// core partitions containing the step count sequence for each core
     std::vector<std::vector<std::size_t>> m_partitions;
@@ -284,8 +1034,28 @@ private:
     /// lookup into the linear arrays
     std::vector<std::vector<std::size_t>> m_partition_indices;
 
+    /// parallel execution options
+    extrapolation_options const m_options;
+
     /// thread pool that dispatches the workers
     std::unique_ptr<threading::pool> m_pool;
+
+    /// shared executor that runs the partitions in place of the thread pool
+    std::shared_ptr<threading::executor> m_executor;
+
+    /// thread team of each partition, for systems that accept one
+    std::vector<std::unique_ptr<threading::team>> m_teams;
+
+    /// private copy of the state advanced by step_async
+    std::unique_ptr<state_type> m_async_state;
+
+    /// pending step_async call, moved out by the background thread when it
+    /// starts running it
+    std::packaged_task<void()> m_async_task;
+
+    /// background thread that runs step_async calls.  declared last so it is
+    /// joined before the state it uses is destroyed
+    std::unique_ptr<threading::worker> m_async_worker;
 };
 
 } // namespace odex
@@ -5,6 +5,7 @@
 #include "odex/make_extrapolation_stepper.hpp"
 #include <cstddef>
 #include <utility>
+#include <future>
 
 
 namespace odex {
@@ -20,11 +21,13 @@ namespace odex {
 /// \param order Order of accuracy of the extrapolation scheme
 /// \param num_cores Maximum number of cores the scheme may run on
 /// \param parallel Flag to distribute work across cores
-template <class Weight=double, class System, class State, class Time, class NumSteps, class Observer>
+/// \param options Tuning options for parallel execution
+template <class Weight=void, class System, class State, class Time, class NumSteps, class Observer>
 State integrate(System&& system, State const& state, Time t, Time dt, NumSteps n, Observer&& observer, 
-                std::size_t order=8, std::size_t num_cores=3, bool parallel=true)
+                std::size_t order=8, std::size_t num_cores=3, bool parallel=true,
+                extrapolation_options const& options=extrapolation_options())
 {
-    auto exstepper = make_extrapolation_stepper<Weight>(std::forward<System>(system), state, order, num_cores, parallel);
+    auto exstepper = make_extrapolation_stepper<Weight>(std::forward<System>(system), state, order, num_cores, parallel, options);
     
     // copy the initial state
     State y(state);
@@ -36,6 +39,23 @@ State integrate(System&& system, State const& state, Time t, Time dt, NumSteps n
     return y;
 }
 
+/// Integrate the differential system on a background thread, returning a
+/// future holding the final state.  The system, initial state and observer
+/// are copied, so the caller's objects are never touched, and the observer is
+/// called on the background thread.  Parameters match integrate().
+template <class Weight=void, class System, class State, class Time, class NumSteps, class Observer>
+std::future<State> integrate_async(System system, State state, Time t, Time dt, NumSteps n, Observer observer,
+                                   std::size_t order=8, std::size_t num_cores=3, bool parallel=true,
+                                   extrapolation_options options=extrapolation_options())
+{
+    auto task = [system = std::move(system), state = std::move(state), t, dt, n, observer = std::move(observer),
+                 order, num_cores, parallel, options = std::move(options)]() mutable
+    {
+        return integrate<Weight>(system, state, t, dt, n, observer, order, num_cores, parallel, options);
+    };
+    return std::async(std::launch::async, std::move(task));
+}
+
 } // namespace odex
 
 #endif // ODEX_INTEGRATE_HPP
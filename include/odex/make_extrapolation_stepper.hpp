@@ -4,7 +4,12 @@
 
 #include "odex/extrapolation_stepper.hpp"
 #include "odex/steppers/gbs.hpp"
+#include "odex/steppers/compact_gbs.hpp"
+#include "odex/steppers/midpoint.hpp"
+#include "odex/steppers/linearly_implicit.hpp"
+#include "odex/steppers/imex.hpp"
 #include "odex/detail/make_extrap_config.hpp"
+#include "odex/detail/stepper_traits.hpp"
 #include <type_traits>
 #include <utility>
 #include <cstddef>
@@ -25,11 +30,27 @@ namespace odex {
 /// \param order Order of accuracy of the extrapolation scheme.
 /// \param num_cores Maximum number of cores the scheme may run on.
 /// \param parallel Flag to distribute work across cores.
-template <class Weight=double, class System, class State>
-auto make_extrapolation_stepper(System&& system, State const& state, std::size_t order=8, std::size_t num_cores=3, bool parallel=true)
+/// \param options Tuning options for parallel execution, including an optional
+/// shared executor such as threading::default_executor().
+/// The extrapolation weights have type Weight, which defaults to double, or
+/// to long double for long double states.  A float state with float weights
+/// steps and combines entirely in single precision.
+/// Each sequence is run by a Stepper<State>, such as steppers::gbs or
+/// steppers::compact_gbs, which holds two leap frog iterates per core
+/// instead of three.  steppers::midpoint skips the smoothing step and is
+/// combined with its own weights, which exist for the order/num_cores pairs
+/// 8/3, 12/4 and 16/5.  steppers::linearly_implicit solves stiff systems
+/// that provide their Jacobian, with weights for the pairs 4/2, 6/2, 8/3 and
+/// 12/3, as does steppers::imex for systems split into a stiff linear
+/// operator and a non-stiff part.  The stability of imex schemes depends on
+/// the non-stiff part, so their isbn() is zero rather than a boundary to
+/// size the time step by.
+template <template <class> class Stepper, class Weight=void, class System, class State>
+auto make_extrapolation_stepper(System&& system, State const& state, std::size_t order=8, std::size_t num_cores=3, bool parallel=true,
+                                extrapolation_options const& options=extrapolation_options())
 {
-    using weight_type = Weight;
-    using stepper_type = odex::steppers::gbs<State>;
+    using weight_type = detail::weight_t<Weight, State>;
+    using stepper_type = Stepper<State>;
     using exstepper_type = odex::extrapolation_stepper<std::decay_t<System>, stepper_type, State, weight_type>;
 
     // avoid unused parameter warning
@@ -39,11 +60,21 @@ auto make_extrapolation_stepper(System&& system, State const& state, std::size_t
     float isbn = 0.0f;
     std::vector<std::size_t> step_counts;
     std::vector<weight_type> weights;
-    std::tie(isbn, step_counts, weights) = detail::make_extrap_config<weight_type>(order, num_cores);
+    std::tie(isbn, step_counts, weights) = detail::make_extrap_config<weight_type>(order, num_cores,
+                                                                                   detail::base_method_of<stepper_type>::value);
 
     // construct the extrapolation stepper
     return exstepper_type(stepper_type(), std::forward<System>(system), step_counts.size(), step_counts.begin(), weights.begin(),
-                          order, isbn, parallel);
+                          order, isbn, parallel, options);
+}
+
+/// Construct an extrapolation_stepper running steppers::gbs.  See above.
+template <class Weight=void, class System, class State>
+auto make_extrapolation_stepper(System&& system, State const& state, std::size_t order=8, std::size_t num_cores=3, bool parallel=true,
+                                extrapolation_options const& options=extrapolation_options())
+{
+    return make_extrapolation_stepper<steppers::gbs, Weight>(std::forward<System>(system), state, order, num_cores,
+                                                             parallel, options);
 }
 
 
@@ -0,0 +1,184 @@
+#ifndef ODEX_MEMORY_ARENA_HPP
+#define ODEX_MEMORY_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <new>
+#if defined(__linux__)
+#  include <sys/mman.h>
+#endif
+
+namespace odex {
+namespace memory {
+
+/// Pages backing an arena.
+///  - standard: regular pages of the operating system
+///  - transparent_huge: regular mapping that the kernel is advised to back
+///    with transparent huge pages (madvise MADV_HUGEPAGE)
+///  - huge: explicit huge pages (mmap MAP_HUGETLB), which must have been
+///    reserved by the administrator.  If none are available the arena falls
+///    back to transparent huge pages
+enum class pages
+{
+    standard,
+    transparent_huge,
+    huge
+};
+
+/// One contiguous, page aligned region of memory handed out by a monotonic
+/// bump pointer.  Memory is only released when the arena is destroyed, and
+/// destroying the objects placed in it is up to their owners.  Pages are not
+/// touched until the memory is first written, so on a first-touch NUMA
+/// system each page lands on the node of the thread that first writes it.
+class arena
+{
+public:
+    /// Alignment of every allocation, one cache line
+    static constexpr std::size_t alignment = 64;
+
+    /// Size of standard pages
+    static constexpr std::size_t standard_page_size = std::size_t(1) << 12;
+
+    /// Size of huge pages
+    static constexpr std::size_t huge_page_size = std::size_t(1) << 21;
+
+    /// Reserve an arena of at least size bytes backed by the requested pages.
+    /// The size is rounded up to a whole number of pages.
+    arena(std::size_t size, memory::pages backing = memory::pages::standard)
+    : m_data(nullptr)
+    , m_size(0)
+    , m_pages(backing)
+    , m_used(0)
+    {
+        auto const page = page_size(backing);
+        m_size = (std::max<std::size_t>(size, 1)+page-1)/page*page;
+#if defined(__linux__)
+        void* data = MAP_FAILED;
+        if (backing == memory::pages::huge)
+        {
+            data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (data == MAP_FAILED)
+            {
+                m_pages = memory::pages::transparent_huge;
+            }
+        }
+        if (data == MAP_FAILED)
+        {
+            data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (data == MAP_FAILED)
+            {
+                throw std::bad_alloc();
+            }
+            if (m_pages == memory::pages::transparent_huge)
+            {
+                madvise(data, m_size, MADV_HUGEPAGE);
+            }
+        }
+        m_data = static_cast<unsigned char*>(data);
+#else
+        m_pages = memory::pages::standard;
+        m_data = static_cast<unsigned char*>(::operator new(m_size, std::align_val_t(page)));
+#endif
+    }
+
+    arena(arena const&) = delete;
+    arena& operator=(arena const&) = delete;
+
+    ~arena()
+    {
+#if defined(__linux__)
+        munmap(m_data, m_size);
+#else
+        ::operator delete(m_data, std::align_val_t(page_size(m_pages)));
+#endif
+    }
+
+    /// Size of the pages of the given kind.
+    static constexpr std::size_t page_size(memory::pages backing)
+    {
+        return backing == memory::pages::standard ? standard_page_size : huge_page_size;
+    }
+
+    /// Start of the arena.
+    unsigned char* data() const
+    {
+        return m_data;
+    }
+
+    /// Number of bytes reserved.
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    /// Pages actually backing the arena, which differs from the requested
+    /// pages if explicit huge pages were unavailable.
+    memory::pages backing() const
+    {
+        return m_pages;
+    }
+
+    /// Number of bytes handed out by allocate().
+    std::size_t used() const
+    {
+        return m_used.load(std::memory_order_relaxed);
+    }
+
+    /// Hand out bytes from the end of the used part of the arena, aligned to
+    /// at least a cache line.  Safe to call concurrently.  Throws
+    /// std::bad_alloc once the arena is exhausted.
+    void* allocate(std::size_t bytes, std::size_t align = alignment)
+    {
+        align = std::max(align, alignment);
+        auto used = m_used.load(std::memory_order_relaxed);
+        std::size_t first;
+        do
+        {
+            first = (used+align-1)/align*align;
+            if (first+bytes > m_size)
+            {
+                throw std::bad_alloc();
+            }
+        }
+        while (!m_used.compare_exchange_weak(used, first+bytes, std::memory_order_relaxed));
+        return m_data+first;
+    }
+
+private:
+    unsigned char* m_data;
+    std::size_t m_size;
+    memory::pages m_pages;
+    std::atomic<std::size_t> m_used;
+};
+
+/// Deleter for objects that were either placed in an arena, which only
+/// need destroying, or allocated with new.
+template <class T>
+struct arena_delete
+{
+    bool in_arena = false;
+
+    void operator()(T* ptr) const
+    {
+        if (in_arena)
+        {
+            ptr->~T();
+        }
+        else
+        {
+            delete ptr;
+        }
+    }
+};
+
+/// Owning pointer to an object that may live in an arena.
+template <class T>
+using arena_ptr = std::unique_ptr<T, arena_delete<T>>;
+
+} // namespace memory
+} // namespace odex
+
+#endif // ODEX_MEMORY_ARENA_HPP
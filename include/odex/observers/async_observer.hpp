@@ -0,0 +1,161 @@
+
+#ifndef ODEX_OBSERVERS_ASYNC_OBSERVER_HPP
+#define ODEX_OBSERVERS_ASYNC_OBSERVER_HPP
+
+#include <condition_variable>
+#include <algorithm>
+#include <type_traits>
+#include <cstddef>
+#include <utility>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+namespace odex {
+namespace observers {
+
+/// What an async_observer does when its ring buffer is full.
+///  - block: the stepping thread waits for a free slot, so every output is
+///    observed but stepping slows to the pace of the observer
+///  - drop: the output is discarded and counted, so stepping never waits
+enum class backpressure
+{
+    block,
+    drop
+};
+
+/// Observer adapter that moves observation off the stepping thread.  Each
+/// call copies the time and state into a preallocated ring of depth slots,
+/// and a background thread passes the copies on to the wrapped observer in
+/// order.  Expensive observers such as compression, file output or plotting
+/// then overlap with stepping rather than stalling it.  Calls must come from
+/// a single thread.  The adapter is not copyable, so pass it by reference or
+/// wrap it in std::ref() where an observer is copied, e.g. step_async().
+template <class Time, class State, class Observer>
+class async_observer
+{
+    async_observer(async_observer const&) = delete;
+public:
+    /// Construct the adapter.
+    /// \param observer Wrapped observer, called on the background thread.
+    /// \param prototype State used to preallocate each slot of the ring.
+    /// \param depth Number of outputs that may be pending at once, at least one.
+    /// \param policy Behavior when all slots are pending.
+    async_observer(Observer observer, State const& prototype, std::size_t depth=8,
+                   backpressure policy=backpressure::block)
+    : m_observer(std::move(observer))
+    , m_times(std::max(depth, std::size_t(1)))
+    , m_states(m_times.size(), prototype)
+    , m_policy(policy)
+    , m_head(0)
+    , m_count(0)
+    , m_dropped(0)
+    , m_exit_flag(false)
+    , m_thread([this]{ _run(); })
+    {    }
+
+    /// Observe every pending output, then join the background thread.
+    ~async_observer()
+    {
+        flush();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_exit_flag = true;
+        }
+        m_not_empty.notify_one();
+        m_thread.join();
+    }
+
+    /// Queue a copy of the time and state for observation.
+    template <class T, class S>
+    void operator()(T const& t, S const& state)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_count == m_states.size())
+        {
+            if (m_policy == backpressure::drop)
+            {
+                ++m_dropped;
+                return;
+            }
+            m_not_full.wait(lock, [this]{ return m_count < m_states.size(); });
+        }
+        auto index = (m_head+m_count) % m_states.size();
+        lock.unlock();
+
+        // the slot is not visible to the background thread until published
+        m_times[index] = t;
+        m_states[index] = state;
+
+        lock.lock();
+        ++m_count;
+        lock.unlock();
+        m_not_empty.notify_one();
+    }
+
+    /// Wait until every queued output has been observed.
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_full.wait(lock, [this]{ return m_count == 0; });
+    }
+
+    /// Number of outputs discarded under backpressure::drop.
+    std::size_t dropped() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_dropped;
+    }
+
+    /// Wrapped observer.  Call flush() before inspecting it.
+    Observer const& observer() const { return m_observer; }
+    Observer      & observer()       { return m_observer; }
+
+private:
+    /// Background thread main loop.
+    void _run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_not_empty.wait(lock, [this]{ return m_exit_flag || m_count > 0; });
+            if (m_count == 0) break;
+
+            auto index = m_head;
+            lock.unlock();
+            m_observer(m_times[index], m_states[index]);
+            lock.lock();
+
+            m_head = (m_head+1) % m_states.size();
+            --m_count;
+            m_not_full.notify_all();
+        }
+    }
+
+private:
+    Observer m_observer;
+    std::vector<Time> m_times;
+    std::vector<State> m_states;
+    backpressure const m_policy;
+    std::size_t m_head;
+    std::size_t m_count;
+    std::size_t m_dropped;
+    bool m_exit_flag;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_not_empty;
+    std::condition_variable m_not_full;
+    std::thread m_thread;
+};
+
+/// Construct an async_observer, deducing the observer and state types.
+template <class Time, class Observer, class State>
+auto make_async_observer(Observer&& observer, State const& prototype, std::size_t depth=8,
+                         backpressure policy=backpressure::block)
+{
+    return async_observer<Time, State, std::decay_t<Observer>>(std::forward<Observer>(observer), prototype, depth, policy);
+}
+
+} // namespace observers
+} // namespace odex
+
+#endif // ODEX_OBSERVERS_ASYNC_OBSERVER_HPP
@@ -0,0 +1,143 @@
+#ifndef ODEX_COMPACT_GBS_HPP
+#define ODEX_COMPACT_GBS_HPP
+
+#include "odex/detail/system_traits.hpp"
+#include "odex/algebra/combine.hpp"
+#include <type_traits>
+#include <cstddef>
+#include <array>
+
+namespace odex {
+namespace steppers {
+
+/// Gragg-Bulirsch-Stoer time stepper holding two leap frog iterates rather
+/// than three.  The leap frog recurrence y_{k+1} = y_{k-1} + 2*h*f(y_k) only
+/// needs y_{k-1} to produce y_{k+1}, so each leap overwrites the older iterate
+/// in place.  The smoothing step .25*(y_{n-1} + 2*y_n + y_{n+1}) is folded
+/// with the last leap into .5*(y_{n-1} + y_n) + .5*h*f(y_n), so y_{n+1} is
+/// never stored.  It evaluates the system as often as gbs and agrees with it
+/// up to rounding, while each core holds one state fewer.
+///
+/// Systems that evaluate in place write the derivative into the output,
+/// which is not needed until the smoothing step.  step_accumulate() has no
+/// output to borrow, so it only accepts the other systems, and extrapolation
+/// steppers step in place systems into an output of their own instead.
+/// Systems that fuse evaluation with the update, system(t, y, base, scale,
+/// out), are called with out being the same state as base and must support
+/// that.
+template <class StateType>
+class compact_gbs
+{
+public:
+    using state_type = StateType;
+    /// two leap frog iterates
+    using scratch_type = std::array<state_type, 2>;
+
+    template <class System, class Time, class Subintervals, class SystemResult>
+    static void step(System&& system, state_type const& y0, state_type& y, Time t, Time dt, Subintervals n, SystemResult&& fval0, scratch_type& scratch)
+    {
+        auto const h = dt/static_cast<Time>(n);
+        auto const& older = _leap_frog(std::forward<System>(system), y0, t, h, n, std::forward<SystemResult>(fval0), scratch, y);
+        auto const& newer = scratch[static_cast<std::size_t>(n)%2];
+
+        // Smoothing Step, evaluating the system at the last iterate
+        _smooth(std::forward<System>(system), t+dt, h, older, newer, y, y);
+    }
+
+    /// Step like step(), but rather than storing the result add weight times
+    /// the result to acc, or assign it to acc if first is set.  The smoothed
+    /// result is formed over the older iterate, so systems that evaluate in
+    /// place without fusing are not accepted.
+    template <class System, class Weight, class Time, class Subintervals, class SystemResult,
+              std::enable_if_t<detail::evaluates_without_derivative<std::remove_reference_t<System>, Time, StateType>::value, int> = 0>
+    static void step_accumulate(System&& system, state_type const& y0, state_type& acc, Weight weight, bool first,
+                                Time t, Time dt, Subintervals n, SystemResult&& fval0, scratch_type& scratch)
+    {
+        // the older iterate, or the unused scratch for a single subinterval,
+        // which the leaps of the systems accepted here never write to
+        auto& smoothed = scratch[(static_cast<std::size_t>(n)+1)%2];
+        auto const h = dt/static_cast<Time>(n);
+        auto const& older = _leap_frog(std::forward<System>(system), y0, t, h, n, std::forward<SystemResult>(fval0), scratch, smoothed);
+        auto const& newer = scratch[static_cast<std::size_t>(n)%2];
+
+        // Smoothing Step over the older iterate, then scaled by the weight
+        _smooth(std::forward<System>(system), t+dt, h, older, newer, smoothed, smoothed);
+        auto const scale = static_cast<Time>(weight);
+        state_type const* inputs[] = { &smoothed };
+        if (first)
+        {
+            algebra::combine(acc, &scale, inputs, 1);
+        }
+        else
+        {
+            algebra::accumulate(acc, &scale, inputs, 1);
+        }
+    }
+
+private:
+    /// Run the forward Euler and leap frog steps up to y_n, which is left in
+    /// scratch[n%2], returning y_{n-1}.  Iterate y_k is held in scratch[k%2],
+    /// and systems that evaluate in place write the derivative into dydt.
+    template <class System, class Time, class Subintervals, class SystemResult>
+    static state_type const& _leap_frog(System&& system, state_type const& y0, Time t, Time h, Subintervals n, SystemResult&& fval0,
+                                        scratch_type& scratch, state_type& dydt)
+    {
+        auto tn = t;
+
+        // Initial Forward Euler Step
+        algebra::scale_sum2(scratch[1], Time(1), y0, h, static_cast<state_type const&>(fval0));
+        tn += h;
+        if (n < 2)
+        {
+            return y0;
+        }
+
+        // First Leap Frog Step to avoid the initial data copy
+        detail::leap(system, tn, h, y0, scratch[1], scratch[0], dydt);
+
+        // Leap Frog Iteration, each overwriting the older iterate
+        for (std::size_t kk = 2; kk < static_cast<std::size_t>(n); ++kk)
+        {
+            tn += h;
+            auto& older = scratch[(kk+1)%2];
+            detail::leap(system, tn, h, older, scratch[kk%2], older, dydt);
+        }
+        return scratch[(static_cast<std::size_t>(n)-1)%2];
+    }
+
+    /// Smoothing step y = .5*(y0 + y1) + .5*h*f(tn, y1), where dydt may be y.
+    template <class System, class Time>
+    static void _smooth(System&& system, Time tn, Time h, state_type const& y0, state_type const& y1,
+                        state_type& y, state_type& dydt)
+    {
+        using system_type = std::remove_reference_t<System>;
+        auto const half = Time(1)/2;
+        if constexpr (detail::evaluates_fused<system_type, Time, state_type>::value)
+        {
+            (void)dydt;
+            algebra::scale_sum2(y, half, y0, half, y1);
+            system(tn, y1, y, half*h, y);
+        }
+        else if constexpr (detail::evaluates_in_place<system_type, Time, state_type>::value)
+        {
+            system(tn, y1, dydt);
+            algebra::scale_sum3(y, half, y0, half, y1, half*h, dydt);
+        }
+        else if constexpr (std::is_same<std::decay_t<decltype(system(tn, y1))>, state_type>::value)
+        {
+            (void)dydt;
+            auto const& result = system(tn, y1);
+            algebra::scale_sum3(y, half, y0, half, y1, half*h, result);
+        }
+        else
+        {
+            (void)dydt;
+            y = half*y0 + half*y1 + half*h*std::forward<System>(system)(tn, y1);
+        }
+    }
+};
+
+} // namespace steppers
+} // namespace odex
+
+#endif // ODEX_COMPACT_GBS_HPP
@@ -2,6 +2,8 @@
 #ifndef ODEX_GBS_HPP
 #define ODEX_GBS_HPP
 
+#include "odex/detail/system_traits.hpp"
+#include "odex/algebra/combine.hpp"
 #include <type_traits>
 #include <cstddef>
 #include <cassert>
@@ -15,25 +17,68 @@ namespace steppers {
 /// accuracy.  In addition, their extrapolates have good imaginary axis 
 /// coverage and are therefore useful in Method Of Lines algorithms for solving
 /// hyperbolic PDE.  
+///
+/// All arithmetic is carried out in the Time type the stepper is called
+/// with, so a float state stepped with float times never leaves single
+/// precision.
 template <class StateType>
 class gbs
 {
 public:
     using state_type = StateType;
+    /// three leap frog iterates
     using scratch_type = std::array<state_type, 3>;
 
     template <class System, class Time, class Subintervals, class SystemResult>
     static void step(System&& system, state_type const& y0, state_type& y, Time t, Time dt, Subintervals n, SystemResult&& fval0, scratch_type& scratch)
     {
-        auto const h = dt/static_cast<float>(n);
-        auto tn = static_cast<decltype(h)>(t);
+        auto const ind = _leap_frog(std::forward<System>(system), y0, t, dt, n, std::forward<SystemResult>(fval0), scratch);
+
+        // Smoothing Step
+        auto const quarter = Time(1)/4;
+        algebra::scale_sum3(y, quarter, scratch[ind[0]], 2*quarter, scratch[ind[1]], quarter, scratch[ind[2]]);
+    }
+
+    /// Step like step(), but rather than storing the result add weight times
+    /// the result to acc, or assign it to acc if first is set.  This lets an
+    /// extrapolation scheme sum its steppers without storing their outputs.
+    template <class System, class Weight, class Time, class Subintervals, class SystemResult>
+    static void step_accumulate(System&& system, state_type const& y0, state_type& acc, Weight weight, bool first,
+                                Time t, Time dt, Subintervals n, SystemResult&& fval0, scratch_type& scratch)
+    {
+        auto const ind = _leap_frog(std::forward<System>(system), y0, t, dt, n, std::forward<SystemResult>(fval0), scratch);
+
+        // Smoothing Step, scaled by the weight
+        auto const scale = static_cast<Time>(weight/4);
+        Time const weights[] = { scale, 2*scale, scale };
+        state_type const* inputs[] = { &scratch[ind[0]], &scratch[ind[1]], &scratch[ind[2]] };
+        if (first)
+        {
+            algebra::combine(acc, weights, inputs, 3);
+        }
+        else
+        {
+            algebra::accumulate(acc, weights, inputs, 3);
+        }
+    }
+
+private:
+    /// Run the forward Euler and leap frog steps, returning the scratch
+    /// indices of the last three iterates, oldest first.
+    template <class System, class Time, class Subintervals, class SystemResult>
+    static std::array<std::size_t,3> _leap_frog(System&& system, state_type const& y0, Time t, Time dt, Subintervals n, SystemResult&& fval0, scratch_type& scratch)
+    {
+        auto const h = dt/static_cast<Time>(n);
+        auto tn = t;
 
         // Initial Forward Euler Step
-        scratch[0] = y0 + h*std::forward<SystemResult>(fval0);
+        algebra::scale_sum2(scratch[0], Time(1), y0, h, static_cast<state_type const&>(fval0));
         tn += h;
 
-        // First Leap Frog Step to avoid the initial data copy
-        scratch[1] = y0 + 2*h*std::forward<System>(system)(tn, scratch[0]);
+        // First Leap Frog Step to avoid the initial data copy.  Systems that
+        // evaluate in place write the derivative into the newest iterate,
+        // which holds a dead iterate, rather than allocating a new state
+        detail::leap(system, tn, h, y0, scratch[0], scratch[1], scratch[1]);
 
         // Leap Frog Iteration
         constexpr std::array<std::array<std::size_t,3>,3> inds{{ {{0, 1, 2}}, {{1, 2, 0}}, {{2, 0, 1}} }};
@@ -45,14 +90,9 @@ public:
             auto const ind0 = inds[cur][0];
             auto const ind1 = inds[cur][1];
             auto const ind2 = inds[cur][2];
-            scratch[ind2] = scratch[ind0] + 2*h*std::forward<System>(system)(tn, scratch[ind1]);
+            detail::leap(system, tn, h, scratch[ind0], scratch[ind1], scratch[ind2], scratch[ind2]);
         }
-
-        // Smoothing Step
-        auto const ind0 = inds[cur][0];
-        auto const ind1 = inds[cur][1];
-        auto const ind2 = inds[cur][2];
-        y = .25f*(scratch[ind0]+2.0f*scratch[ind1]+scratch[ind2]);
+        return inds[cur];
     }
 };
 
@@ -0,0 +1,142 @@
+
+#ifndef ODEX_IMEX_HPP
+#define ODEX_IMEX_HPP
+
+#include "odex/detail/linearly_implicit.hpp"
+#include "odex/detail/system_traits.hpp"
+#include "odex/detail/stepper_traits.hpp"
+#include "odex/algebra/band_matrix.hpp"
+#include "odex/algebra/state_traits.hpp"
+#include <type_traits>
+#include <functional>
+#include <cstddef>
+#include <vector>
+#include <array>
+
+namespace odex {
+namespace steppers {
+
+/// Implicit-explicit time stepper for split systems f(t, y) = N(t, y) + L*y,
+/// with a non-stiff part N and a constant stiff linear operator L.  It is the
+/// linearly implicit midpoint rule of steppers::linearly_implicit with L in
+/// place of the Jacobian, so L is treated implicitly and N explicitly, and
+/// since the error of that rule expands in even powers of the substep
+/// whatever matrix it uses, it is extrapolated with the same weights.
+///
+/// The system evaluates N as usual, through any of the protocols the other
+/// steppers accept, and provides L in one of two ways:
+///  - system.linear_operator(L), shaping and filling the algebra::band_matrix
+///    L with resize() and its entries.  L is read on the first step, and
+///    I - h*L is factored as a banded LU for each step count, which is kept
+///    until the time step size changes.  States must be contiguous.
+///  - system.apply_linear(y, base, scale, out), computing out = base +
+///    scale*L*y where out may be base, and
+///    system.solve_linear(h, b), overwriting b with the solution x of
+///    (I - h*L) x = b, for operators with their own solvers, such as
+///    diagonalizing transforms.  Each partition calls its own copy of the
+///    system, which may cache whatever it needs for each h.
+template <class StateType>
+class imex
+{
+public:
+    using state_type = StateType;
+    using value_type = typename detail::stepping_time<state_type, double>::type;
+    using matrix_type = algebra::band_matrix<value_type>;
+
+    /// Selects the linearly implicit extrapolation weights in make_extrap_config,
+    /// without a stability boundary.
+    static constexpr detail::base_method method = detail::base_method::imex;
+
+    /// increment D and the work state it is solved in
+    using scratch_type = std::array<state_type, 2>;
+
+    imex()
+    : m_dt(0)
+    , m_factorizations()
+    {    }
+
+    /// Read a banded linear operator on the first step, and mark its
+    /// factorizations out of date whenever the time step size changes.  Runs
+    /// alone, before any sequence steps.
+    template <class System, class Time>
+    void prepare(System& system, Time t, Time dt, state_type const& y0, std::vector<std::size_t> const& step_counts)
+    {
+        static_assert(detail::provides_linear_operator<System, matrix_type>::value ||
+                      detail::solves_linear<System, Time, state_type>::value,
+                      "imex steppers require system.linear_operator(L), or "
+                      "system.apply_linear(y, base, scale, out) and system.solve_linear(h, b)");
+        (void)t;
+        (void)y0;
+        if constexpr (detail::provides_linear_operator<System, matrix_type>::value)
+        {
+            static_assert(algebra::is_contiguous_v<state_type>, "banded linear operators require contiguous states");
+            auto const first = m_factorizations.epoch() == 0;
+            if (first)
+            {
+                system.linear_operator(m_factorizations.matrix());
+            }
+            if (first || std::not_equal_to<Time>()(dt, static_cast<Time>(m_dt)))
+            {
+                m_dt = static_cast<value_type>(dt);
+                m_factorizations.invalidate(step_counts);
+            }
+        }
+        else
+        {
+            (void)dt;
+            (void)step_counts;
+        }
+    }
+
+    template <class System, class Time, class Subintervals, class SystemResult>
+    void step(System&& system, state_type const& y0, state_type& y, Time t, Time dt, Subintervals n, SystemResult&& fval0, scratch_type& scratch) const
+    {
+        auto& split = detail::underlying_system(system);
+        using split_type = std::remove_reference_t<decltype(split)>;
+        auto const& fval = static_cast<state_type const&>(fval0);
+        if constexpr (detail::provides_linear_operator<split_type, matrix_type>::value)
+        {
+            // b += scale*L*y and b = (I - h*L)^{-1} b with the banded operator
+            using traits = algebra::contiguous_traits<state_type>;
+            auto const h = dt/static_cast<Time>(n);
+            auto const& lu = m_factorizations.factor(static_cast<std::size_t>(n), h);
+            auto const& linear = m_factorizations.matrix();
+            auto const add_linear = [&linear](Time scale, state_type const& x, state_type& b)
+            {
+                linear.multiply_add(scale, traits::data(x), traits::data(b));
+            };
+            auto const solve = [&lu](state_type& b)
+            {
+                lu.solve(traits::data(b));
+            };
+            detail::linearly_implicit_step(system, y0, y, t, dt, n, fval, scratch, add_linear, solve);
+        }
+        else
+        {
+            // the same through the system's own operator and solver
+            auto const h = dt/static_cast<Time>(n);
+            auto const add_linear = [&split](Time scale, state_type const& x, state_type& b)
+            {
+                split.apply_linear(x, b, scale, b);
+            };
+            auto const solve = [&split, h](state_type& b)
+            {
+                split.solve_linear(h, b);
+            };
+            detail::linearly_implicit_step(system, y0, y, t, dt, n, fval, scratch, add_linear, solve);
+        }
+    }
+
+private:
+    /// time step size the factorizations are made for
+    value_type m_dt;
+
+    /// banded linear operator, read on the first step, and the factorization
+    /// of I - h*L for each step count
+    detail::factorization_cache<matrix_type> m_factorizations;
+};
+
+} // namespace steppers
+} // namespace odex
+
+#endif // ODEX_IMEX_HPP
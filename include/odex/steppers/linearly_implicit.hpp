@@ -0,0 +1,91 @@
+
+#ifndef ODEX_LINEARLY_IMPLICIT_HPP
+#define ODEX_LINEARLY_IMPLICIT_HPP
+
+#include "odex/detail/linearly_implicit.hpp"
+#include "odex/detail/system_traits.hpp"
+#include "odex/detail/stepper_traits.hpp"
+#include "odex/algebra/band_matrix.hpp"
+#include "odex/algebra/state_traits.hpp"
+#include <cstddef>
+#include <vector>
+#include <array>
+
+namespace odex {
+namespace steppers {
+
+/// Bader and Deuflhard's linearly implicit midpoint time stepper for stiff
+/// systems.  With J the Jacobian at the initial state and h the substep,
+/// each substep solves a linear system with I - h*J in place of an explicit
+/// leap frog update:
+///     D_0 = (I - h*J)^{-1} h*f(y_0),                    y_1 = y_0 + D_0
+///     D_k = D_{k-1} + 2*(I - h*J)^{-1} (h*f(y_k) - D_{k-1}),  y_{k+1} = y_k + D_k
+/// and a final smoothing substep adds (I - h*J)^{-1} (h*f(y_n) - D_{n-1})
+/// to y_n.  Its error expands in even powers of h whatever J is, so it is
+/// extrapolated like gbs, but with the weights selected by its method, and
+/// the time derivative of a non-autonomous system is left to the
+/// extrapolation.
+///
+/// Systems provide their Jacobian as system.jacobian(t, y, J), shaping the
+/// algebra::band_matrix J with resize(), which zeroes it, and setting the
+/// entries in its band.  prepare() evaluates it once per step for every
+/// sequence and partition.  The stepper keeps a factorization of I - h*J
+/// for each step count, which the thread running that sequence refactors
+/// once per step and reuses for all of its substeps.  States must be
+/// contiguous.
+template <class StateType>
+class linearly_implicit
+{
+public:
+    using state_type = StateType;
+    static_assert(algebra::is_contiguous_v<state_type>, "linearly implicit steppers require contiguous states");
+    using value_type = typename algebra::contiguous_traits<state_type>::value_type;
+    using matrix_type = algebra::band_matrix<value_type>;
+
+    /// Selects the linearly implicit extrapolation weights in make_extrap_config.
+    static constexpr detail::base_method method = detail::base_method::linearly_implicit;
+
+    /// increment D and the work state it is solved in
+    using scratch_type = std::array<state_type, 2>;
+
+    linearly_implicit()
+    : m_factorizations()
+    {    }
+
+    /// Evaluate the Jacobian at the initial state of the step, shared by
+    /// every sequence, and mark the factorizations out of date.  Runs alone,
+    /// before any sequence steps.
+    template <class System, class Time>
+    void prepare(System& system, Time t, Time dt, state_type const& y0, std::vector<std::size_t> const& step_counts)
+    {
+        static_assert(detail::provides_jacobian<System, Time, state_type, matrix_type>::value,
+                      "linearly implicit steppers require system.jacobian(t, y, J)");
+        (void)dt;
+        system.jacobian(t, y0, m_factorizations.matrix());
+        m_factorizations.invalidate(step_counts);
+    }
+
+    template <class System, class Time, class Subintervals, class SystemResult>
+    void step(System&& system, state_type const& y0, state_type& y, Time t, Time dt, Subintervals n, SystemResult&& fval0, scratch_type& scratch) const
+    {
+        auto const h = dt/static_cast<Time>(n);
+        auto const& lu = m_factorizations.factor(static_cast<std::size_t>(n), h);
+        auto const add_linear = [](Time, state_type const&, state_type&) {};
+        auto const solve = [&lu](state_type& b)
+        {
+            lu.solve(algebra::contiguous_traits<state_type>::data(b));
+        };
+        detail::linearly_implicit_step(system, y0, y, t, dt, n, static_cast<state_type const&>(fval0), scratch,
+                                       add_linear, solve);
+    }
+
+private:
+    /// Jacobian at the initial state of the current step, and the
+    /// factorization of I - h*J for each step count
+    detail::factorization_cache<matrix_type> m_factorizations;
+};
+
+} // namespace steppers
+} // namespace odex
+
+#endif // ODEX_LINEARLY_IMPLICIT_HPP
@@ -0,0 +1,98 @@
+
+#ifndef ODEX_MIDPOINT_HPP
+#define ODEX_MIDPOINT_HPP
+
+#include "odex/detail/system_traits.hpp"
+#include "odex/detail/stepper_traits.hpp"
+#include "odex/algebra/combine.hpp"
+#include <type_traits>
+#include <cstddef>
+#include <array>
+
+namespace odex {
+namespace steppers {
+
+/// Explicit midpoint time stepper without Gragg's smoothing step.  For an
+/// even number of substeps the leap frog iterate y_n itself has an error
+/// expansion in even powers of the substep, so it extrapolates like gbs
+/// while saving one system evaluation and the smoothing sweep per sequence.
+/// Its extrapolates have smaller imaginary stability boundaries, so they
+/// are combined with their own weights, selected by its method.
+///
+/// Each leap overwrites the older iterate in place, as in compact_gbs, and
+/// the last leap writes straight into the output.  Systems that evaluate in
+/// place write the derivative into the output until then, so step_accumulate()
+/// only accepts the other systems, as in compact_gbs.  Systems that fuse
+/// evaluation with the update, system(t, y, base, scale, out), are called
+/// with out being the same state as base and must support that.
+template <class StateType>
+class midpoint
+{
+public:
+    using state_type = StateType;
+    /// two leap frog iterates
+    using scratch_type = std::array<state_type, 2>;
+
+    /// Selects the unsmoothed extrapolation weights in make_extrap_config.
+    static constexpr detail::base_method method = detail::base_method::midpoint;
+
+    template <class System, class Time, class Subintervals, class SystemResult>
+    static void step(System&& system, state_type const& y0, state_type& y, Time t, Time dt, Subintervals n, SystemResult&& fval0, scratch_type& scratch)
+    {
+        _leap_frog(std::forward<System>(system), y0, y, t, dt, n, std::forward<SystemResult>(fval0), scratch);
+    }
+
+    /// Step like step(), but rather than storing the result add weight times
+    /// the result to acc, or assign it to acc if first is set.  The result is
+    /// formed in the scratch iterate it would otherwise have overwritten, so
+    /// systems that evaluate in place without fusing are not accepted.
+    template <class System, class Weight, class Time, class Subintervals, class SystemResult,
+              std::enable_if_t<detail::evaluates_without_derivative<std::remove_reference_t<System>, Time, StateType>::value, int> = 0>
+    static void step_accumulate(System&& system, state_type const& y0, state_type& acc, Weight weight, bool first,
+                                Time t, Time dt, Subintervals n, SystemResult&& fval0, scratch_type& scratch)
+    {
+        auto& result = scratch[static_cast<std::size_t>(n)%2];
+        _leap_frog(std::forward<System>(system), y0, result, t, dt, n, std::forward<SystemResult>(fval0), scratch);
+
+        auto const scale = static_cast<Time>(weight);
+        state_type const* inputs[] = { &result };
+        if (first)
+        {
+            algebra::combine(acc, &scale, inputs, 1);
+        }
+        else
+        {
+            algebra::accumulate(acc, &scale, inputs, 1);
+        }
+    }
+
+private:
+    /// Run the forward Euler and leap frog steps, writing y_n to y.  Iterate
+    /// y_k is held in scratch[k%2] until it is overwritten by y_{k+2}, and
+    /// systems that evaluate in place write the derivative into y.
+    template <class System, class Time, class Subintervals, class SystemResult>
+    static void _leap_frog(System&& system, state_type const& y0, state_type& y, Time t, Time dt, Subintervals n, SystemResult&& fval0, scratch_type& scratch)
+    {
+        auto const h = dt/static_cast<Time>(n);
+        auto const steps = static_cast<std::size_t>(n);
+        auto tn = t;
+
+        // Initial Forward Euler Step
+        algebra::scale_sum2(steps < 2 ? y : scratch[1], Time(1), y0, h, static_cast<state_type const&>(fval0));
+
+        // Leap Frog Iteration, the first from the initial data to avoid a copy
+        for (std::size_t kk = 1; kk < steps; ++kk)
+        {
+            tn += h;
+            auto const& older = kk == 1 ? y0 : scratch[(kk+1)%2];
+            auto& newer = kk+1 == steps ? y : scratch[(kk+1)%2];
+            detail::leap(system, tn, h, older, scratch[kk%2], newer, y);
+        }
+    }
+
+};
+
+} // namespace steppers
+} // namespace odex
+
+#endif // ODEX_MIDPOINT_HPP
@@ -0,0 +1,246 @@
+
+#ifndef ODEX_THREADING_AFFINITY_HPP
+#define ODEX_THREADING_AFFINITY_HPP
+
+#include <algorithm>
+#include <fstream>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+#include <tuple>
+#if defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+namespace odex {
+namespace threading {
+
+/// Location of a logical cpu in the machine topology.
+struct cpu_info
+{
+    /// Operating system id of the logical cpu
+    int id;
+
+    /// Socket containing the cpu
+    int package;
+
+    /// Physical core containing the cpu, unique within its package
+    int core;
+};
+
+/// Logical cpus this process may run on, with their socket and core ids.  On
+/// Linux this reads the sysfs topology for the cpus in the process affinity
+/// mask.  Elsewhere every hardware thread is reported as its own core.
+inline std::vector<cpu_info> cpu_topology()
+{
+    std::vector<cpu_info> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        auto read_id = [](int cpu, char const* name, int fallback)
+        {
+            std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name;
+            std::ifstream file(path);
+            int value = fallback;
+            if (!(file >> value))
+            {
+                value = fallback;
+            }
+            return value;
+        };
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(static_cast<std::size_t>(cpu), &set))
+            {
+                cpus.push_back(cpu_info{cpu, read_id(cpu, "physical_package_id", 0), read_id(cpu, "core_id", cpu)});
+            }
+        }
+    }
+#endif
+    if (cpus.empty())
+    {
+        int count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int cpu = 0; cpu < count; ++cpu)
+        {
+            cpus.push_back(cpu_info{cpu, 0, cpu});
+        }
+    }
+    return cpus;
+}
+
+/// Pin the calling thread to a logical cpu.  Returns false if pinning failed
+/// or is not supported on this platform.
+inline bool pin_current_thread(int cpu)
+{
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<std::size_t>(cpu), &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+/// Thread placement policy.  Maps the threads of a pool onto logical cpus:
+///  - none: threads are left to the operating system scheduler
+///  - explicit_cores: threads are pinned to a caller supplied cpu list
+///  - compact: consecutive threads fill a socket, hyperthreads first
+///  - scatter: consecutive threads alternate between sockets, using every
+///    physical core before any hyperthread sibling
+///  - physical_cores: like compact, but one thread per physical core
+/// If there are more threads than cpus the placement wraps around.
+class affinity
+{
+public:
+    enum class placement
+    {
+        none,
+        explicit_cores,
+        compact,
+        scatter,
+        physical_cores
+    };
+
+    /// Leave thread placement to the operating system.
+    static affinity none()
+    {
+        return affinity(placement::none, {});
+    }
+
+    /// Pin thread ii to cpus[ii].
+    static affinity cores(std::vector<int> cpus)
+    {
+        return affinity(placement::explicit_cores, std::move(cpus));
+    }
+
+    /// Pack threads as tightly as possible.
+    static affinity compact()
+    {
+        return affinity(placement::compact, {});
+    }
+
+    /// Spread threads across sockets and physical cores.
+    static affinity scatter()
+    {
+        return affinity(placement::scatter, {});
+    }
+
+    /// Place at most one thread per physical core.
+    static affinity physical_cores()
+    {
+        return affinity(placement::physical_cores, {});
+    }
+
+    /// Placement kind.
+    placement kind() const
+    {
+        return m_kind;
+    }
+
+    /// Cpu ids for count threads, in thread order.  An id of -1 leaves the
+    /// thread unpinned.
+    std::vector<int> cpus(std::size_t count) const
+    {
+        std::vector<int> order;
+        switch (m_kind)
+        {
+        case placement::none:
+            break;
+        case placement::explicit_cores:
+            order = m_cpus;
+            break;
+        case placement::compact:
+        case placement::scatter:
+        case placement::physical_cores:
+            order = _topology_order(cpu_topology());
+            break;
+        }
+
+        if (order.empty())
+        {
+            return std::vector<int>(count, -1);
+        }
+        std::vector<int> result(count);
+        for (std::size_t ii = 0; ii < count; ++ii)
+        {
+            result[ii] = order[ii % order.size()];
+        }
+        return result;
+    }
+
+private:
+    affinity(placement kind, std::vector<int> cpus)
+    : m_kind(kind)
+    , m_cpus(std::move(cpus))
+    {    }
+
+    /// Order the topology according to the placement kind.
+    std::vector<int> _topology_order(std::vector<cpu_info> topology) const
+    {
+        // compact ordering: socket, then core, then hyperthread
+        std::sort(topology.begin(), topology.end(), [](cpu_info const& a, cpu_info const& b)
+        {
+            return std::tie(a.package, a.core, a.id) < std::tie(b.package, b.core, b.id);
+        });
+
+        // rank of each cpu among its core's siblings, and of its core within the socket
+        std::vector<std::size_t> sibling(topology.size(), 0);
+        std::vector<std::size_t> core_rank(topology.size(), 0);
+        for (std::size_t ii = 1; ii < topology.size(); ++ii)
+        {
+            auto const& prev = topology[ii-1];
+            auto const& cur = topology[ii];
+            bool same_package = prev.package == cur.package;
+            bool same_core = same_package && prev.core == cur.core;
+            sibling[ii] = same_core ? sibling[ii-1]+1 : 0;
+            core_rank[ii] = same_core ? core_rank[ii-1] : (same_package ? core_rank[ii-1]+1 : 0);
+        }
+
+        std::vector<std::size_t> indices(topology.size());
+        for (std::size_t ii = 0; ii < indices.size(); ++ii)
+        {
+            indices[ii] = ii;
+        }
+
+        if (m_kind == placement::physical_cores)
+        {
+            indices.erase(std::remove_if(indices.begin(), indices.end(),
+                                         [&](std::size_t ii){ return sibling[ii] != 0; }),
+                          indices.end());
+        }
+        else if (m_kind == placement::scatter)
+        {
+            std::stable_sort(indices.begin(), indices.end(), [&](std::size_t a, std::size_t b)
+            {
+                return std::tie(sibling[a], core_rank[a], topology[a].package) <
+                       std::tie(sibling[b], core_rank[b], topology[b].package);
+            });
+        }
+
+        std::vector<int> order(indices.size());
+        for (std::size_t ii = 0; ii < indices.size(); ++ii)
+        {
+            order[ii] = topology[indices[ii]].id;
+        }
+        return order;
+    }
+
+private:
+    placement m_kind;
+    std::vector<int> m_cpus;
+};
+
+} // namespace threading
+} // namespace odex
+
+#endif // ODEX_THREADING_AFFINITY_HPP
@@ -0,0 +1,122 @@
+
+#ifndef ODEX_THREADING_EPOCH_HPP
+#define ODEX_THREADING_EPOCH_HPP
+
+#include "odex/threading/wait_policy.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <atomic>
+#if defined(__linux__)
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#else
+#  include <condition_variable>
+#  include <mutex>
+#endif
+
+namespace odex {
+namespace threading {
+
+/// Monotonic counter that threads can wait on.  A signaling thread calls
+/// advance(), while waiters call wait() with the last value they observed and
+/// return once the counter has moved past it.  Waiters first spin on the
+/// atomic value as directed by their wait_policy, then block.  On Linux the
+/// blocking wait is a futex on the counter itself, so neither side takes a
+/// lock; elsewhere it falls back to a condition variable.  The signaling
+/// thread only enters the kernel when a waiter is actually blocked.
+class epoch
+{
+    epoch(epoch const&) = delete;
+public:
+    /// Construct the epoch at value zero.
+    epoch()
+    : m_value(0)
+    , m_sleepers(0)
+    {    }
+
+    /// Current value of the epoch.
+    std::uint32_t value() const
+    {
+        return m_value.load(std::memory_order_acquire);
+    }
+
+    /// Advance the epoch, waking all waiters.
+    void advance()
+    {
+        // Sequentially consistent ordering pairs with the sleeper registration
+        // in wait(): either the waiter sees the new value or we see the waiter.
+        m_value.fetch_add(1, std::memory_order_seq_cst);
+        if (m_sleepers.load(std::memory_order_seq_cst) != 0)
+        {
+            _wake_all();
+        }
+    }
+
+    /// Wait until the epoch differs from last, returning the new value.
+    std::uint32_t wait(std::uint32_t last, wait_policy const& policy)
+    {
+        for (std::size_t ii = 0; ii < policy.spin_count; ++ii)
+        {
+            auto current = m_value.load(std::memory_order_acquire);
+            if (current != last)
+            {
+                return current;
+            }
+            spin_pause(ii);
+        }
+
+        m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+        _block(last);
+        m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+        return m_value.load(std::memory_order_acquire);
+    }
+
+private:
+#if defined(__linux__)
+    /// Sleep in the kernel until the value is no longer last.  The kernel
+    /// rechecks the value atomically, so a concurrent advance() is never lost.
+    void _block(std::uint32_t last)
+    {
+        while (m_value.load(std::memory_order_seq_cst) == last)
+        {
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&m_value), FUTEX_WAIT_PRIVATE, last, nullptr, nullptr, 0);
+        }
+    }
+
+    /// Wake every thread sleeping in _block().
+    void _wake_all()
+    {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&m_value), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    }
+#else
+    /// Sleep on the condition variable until the value is no longer last.
+    void _block(std::uint32_t last)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this, last]{ return m_value.load(std::memory_order_seq_cst) != last; });
+    }
+
+    /// Wake every thread sleeping in _block().  Taking the mutex ensures a
+    /// waiter is either before its predicate check or already waiting.
+    void _wake_all()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cv.notify_all();
+    }
+#endif
+
+private:
+    std::atomic<std::uint32_t> m_value;
+    std::atomic<std::size_t> m_sleepers;
+#if !defined(__linux__)
+    std::condition_variable m_cv;
+    std::mutex m_mutex;
+#endif
+};
+
+} // namespace threading
+} // namespace odex
+
+#endif // ODEX_THREADING_EPOCH_HPP
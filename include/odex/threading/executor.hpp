@@ -0,0 +1,57 @@
+
+#ifndef ODEX_THREADING_EXECUTOR_HPP
+#define ODEX_THREADING_EXECUTOR_HPP
+
+#include <type_traits>
+#include <cstddef>
+#include <memory>
+
+namespace odex {
+namespace threading {
+
+/// Non-owning reference to a callable taking a task index.  The referenced
+/// callable must outlive the task_ref.  Unlike std::function, constructing a
+/// task_ref never allocates, so tasks can be submitted every time step.
+class task_ref
+{
+public:
+    template <class Function,
+              class = std::enable_if_t<!std::is_same<std::decay_t<Function>, task_ref>{}>>
+    task_ref(Function& function)
+    : m_object(&function)
+    , m_call([](void* object, std::size_t index){ (*static_cast<Function*>(object))(index); })
+    {    }
+
+    /// Run the task at index.
+    void operator()(std::size_t index) const
+    {
+        m_call(m_object, index);
+    }
+
+private:
+    void* m_object;
+    void (*m_call)(void*, std::size_t);
+};
+
+/// Interface for an executor that runs batches of indexed tasks.  Executors
+/// can be shared by many extrapolation_steppers, so that any number of live
+/// steppers submit their partitions to one set of threads instead of each
+/// owning a thread pool.
+class executor
+{
+public:
+    virtual ~executor() = default;
+
+    /// Number of threads that run tasks on behalf of callers.
+    virtual std::size_t concurrency() const = 0;
+
+    /// Run task(ii) for every ii in [0, count).  The calling thread takes part
+    /// in running the tasks, and this call does not return until they have
+    /// all completed.  Safe to call concurrently from multiple threads.
+    virtual void bulk_run(std::size_t count, task_ref task) = 0;
+};
+
+} // namespace threading
+} // namespace odex
+
+#endif // ODEX_THREADING_EXECUTOR_HPP
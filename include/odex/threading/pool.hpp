@@ -3,11 +3,14 @@
 #define ODEX_THREADING_POOL_HPP
 
 #include "odex/threading/worker.hpp"
-#include "odex/threading/semaphore.hpp"
+#include "odex/threading/wait_policy.hpp"
+#include "odex/threading/epoch.hpp"
 #include <cassert>
 #include <cstddef>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <atomic>
 
 namespace odex { 
 namespace threading {
@@ -16,14 +19,22 @@ namespace threading {
 /// may have its own distinct target load function.  Individual workers can
 /// be told to process via calls to notify().  To guarantee synchronization,
 /// process() dispatches all the workers and does not return until all have
-/// completed their work.
+/// completed their work.  Completion is tracked with an atomic counter; the
+/// last worker to finish advances an epoch that process() waits on, so the
+/// completion path takes no locks.  The wait_policy applies both to idle workers
+/// waiting for notification and to process() waiting for completion.
+/// Workers can be pinned to cpus, typically chosen by a threading::affinity.
 class pool
 {
     pool(pool const&) = delete;
 public:
-    /// Construct the thread pool with a number of workers
-    explicit pool(std::size_t num_workers)
+    /// Construct the thread pool with a number of workers.  Worker ii is pinned
+    /// to cpus[ii] if that entry exists and is non-negative.
+    explicit pool(std::size_t num_workers, wait_policy policy = wait_policy::blocking(),
+                  std::vector<int> cpus = std::vector<int>())
     : m_workers(num_workers)
+    , m_policy(policy)
+    , m_cpus(std::move(cpus))
     , m_completion_count(0)
     {
 
@@ -49,7 +60,8 @@ public:
     void emplace(std::size_t index, Function&& function, Args&&... args)
     {
         assert(index < m_workers.size() && "Worker index out of range!");
-        m_workers[index].reset(new worker(_make_target(std::forward<Function>(function), std::forward<Args>(args)...)));
+        int cpu = index < m_cpus.size() ? m_cpus[index] : -1;
+        m_workers[index].reset(new worker(m_policy, cpu, _make_target(std::forward<Function>(function), std::forward<Args>(args)...)));
     }
 
     /// Tell the workers to process, synchronizing.  This call does not return
@@ -58,14 +70,21 @@ public:
     /// worker processing completion is then left to the caller.
     void process()
     {
-        std::size_t count = m_workers.size();
-        for (std::size_t ii = 0; ii < count; ++ii)
-        {
-            notify(ii);
-        }
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_cv.wait(lock, [this, count]{return m_completion_count == count;});
-        m_completion_count = 0;
+        auto seen = m_completion.value();
+        notify();
+        _wait_for_completion(seen);
+    }
+
+    /// Tell the workers to process while the calling thread runs local.  This
+    /// call does not return until local and all workers have finished.  Running
+    /// a share of the work on the caller saves a thread and a wake-up.
+    template <class Function>
+    void process(Function&& local)
+    {
+        auto seen = m_completion.value();
+        notify();
+        std::forward<Function>(local)();
+        _wait_for_completion(seen);
     }
 
     /// Notify all worker to process.
@@ -107,6 +126,21 @@ public:
     }
 
 private:
+    /// Wait for all workers to finish processing, then reset the count.
+    /// seen is the completion epoch observed before the workers were notified.
+    void _wait_for_completion(std::uint32_t seen)
+    {
+        if (m_workers.empty())
+        {
+            return;
+        }
+        m_completion.wait(seen, m_policy);
+
+        // every worker has arrived, so nobody else touches the count until
+        // the next notification, which publishes this store
+        m_completion_count.store(0, std::memory_order_relaxed);
+    }
+
     /// Make the target function.
     template <class Function, class... Args>
     auto _make_target(Function&& function, Args&&... args)
@@ -116,25 +150,21 @@ private:
             // Call the target function
             function(args...);
 
-            // Get the lock
-            std::lock_guard<std::mutex> lock(m_mutex);
-
-            // Bump the number of finished threads
-            ++m_completion_count;
-
-            // If all workers are done, notify the main thread
-            if (m_completion_count == m_workers.size())
+            // Bump the number of finished threads.  The last one to arrive
+            // advances the completion epoch, waking the main thread
+            if (m_completion_count.fetch_add(1, std::memory_order_acq_rel)+1 == m_workers.size())
             {
-                m_cv.notify_one();
+                m_completion.advance();
             }
         };
     }
 
 private:
     std::vector<std::unique_ptr<worker>> m_workers;
-    std::condition_variable m_cv;
-    std::mutex m_mutex;
-    std::size_t m_completion_count;
+    wait_policy const m_policy;
+    std::vector<int> const m_cpus;
+    std::atomic<std::size_t> m_completion_count;
+    epoch m_completion;
 };
 
 } // namespace odex
@@ -0,0 +1,203 @@
+
+#ifndef ODEX_THREADING_SHARED_POOL_HPP
+#define ODEX_THREADING_SHARED_POOL_HPP
+
+#include "odex/threading/executor.hpp"
+#include <condition_variable>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+namespace odex {
+namespace threading {
+
+/// Executor backed by a fixed set of threads shared between all callers.
+/// Each bulk_run() call posts a job to a queue; idle threads claim the next
+/// unclaimed task index from the oldest job, while the submitting thread
+/// works through its own job.  Jobs live on the submitting thread's stack,
+/// so submission does not allocate.
+class shared_pool : public executor
+{
+    shared_pool(shared_pool const&) = delete;
+public:
+    /// Construct the pool with a number of threads.
+    explicit shared_pool(std::size_t num_threads)
+    : m_head(nullptr)
+    , m_tail(nullptr)
+    , m_exit_flag(false)
+    {
+        for (std::size_t ii = 0; ii < num_threads; ++ii)
+        {
+            m_threads.emplace_back([this]{ _run(); });
+        }
+    }
+
+    /// Destroy the pool, joining its threads.  No bulk_run() may be pending.
+    ~shared_pool() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_exit_flag = true;
+        }
+        m_work_cv.notify_all();
+        for (auto& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    /// Number of pool threads.
+    std::size_t concurrency() const override
+    {
+        return m_threads.size();
+    }
+
+    /// Run task(ii) for ii in [0, count), returning once all have completed.
+    void bulk_run(std::size_t count, task_ref task) override
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        job current(task, count);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (count > 1 && !m_threads.empty())
+        {
+            _push(&current);
+            lock.unlock();
+            m_work_cv.notify_all();
+            lock.lock();
+        }
+
+        // work through this job on the calling thread
+        while (current.next < current.count)
+        {
+            auto index = _claim(&current);
+            lock.unlock();
+            _execute(&current, index);
+            lock.lock();
+        }
+
+        // wait for the tasks claimed by pool threads
+        m_done_cv.wait(lock, [&current]{ return current.remaining == 0; });
+    }
+
+private:
+    /// A batch of tasks posted by one bulk_run() call.  All fields are guarded
+    /// by the pool mutex.
+    struct job
+    {
+        job(task_ref t, std::size_t n)
+        : task(t), count(n), next(0), remaining(n), link(nullptr)
+        {    }
+
+        task_ref task;
+        std::size_t count;
+        std::size_t next;
+        std::size_t remaining;
+        job* link;
+    };
+
+    /// Append a job to the queue.  Requires the lock.
+    void _push(job* j)
+    {
+        if (m_tail)
+        {
+            m_tail->link = j;
+        }
+        else
+        {
+            m_head = j;
+        }
+        m_tail = j;
+    }
+
+    /// Claim the next task index of a job, removing the job from the queue
+    /// once all of its tasks are claimed.  Requires the lock.
+    std::size_t _claim(job* j)
+    {
+        auto index = j->next++;
+        if (j->next == j->count)
+        {
+            _unlink(j);
+        }
+        return index;
+    }
+
+    /// Remove a job from the queue if it is queued.  Requires the lock.
+    void _unlink(job* j)
+    {
+        job* prev = nullptr;
+        for (job* cur = m_head; cur; prev = cur, cur = cur->link)
+        {
+            if (cur == j)
+            {
+                (prev ? prev->link : m_head) = cur->link;
+                if (m_tail == cur)
+                {
+                    m_tail = prev;
+                }
+                cur->link = nullptr;
+                return;
+            }
+        }
+    }
+
+    /// Run one task of a job, then record its completion.
+    void _execute(job* j, std::size_t index)
+    {
+        j->task(index);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--j->remaining == 0)
+        {
+            // notify while holding the lock so the submitter cannot return
+            // and destroy the job before we are done touching it
+            m_done_cv.notify_all();
+        }
+    }
+
+    /// Pool thread main loop.
+    void _run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_work_cv.wait(lock, [this]{ return m_exit_flag || m_head; });
+            if (m_exit_flag) break;
+
+            job* j = m_head;
+            auto index = _claim(j);
+            lock.unlock();
+            _execute(j, index);
+            lock.lock();
+        }
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    std::mutex m_mutex;
+    job* m_head;
+    job* m_tail;
+    bool m_exit_flag;
+};
+
+/// Process-wide executor with one thread per hardware thread, less one for
+/// the submitting thread that also runs tasks.  Constructed on first use.
+inline std::shared_ptr<executor> default_executor()
+{
+    static std::shared_ptr<executor> instance =
+        std::make_shared<shared_pool>(std::max(1u, std::thread::hardware_concurrency())-1);
+    return instance;
+}
+
+} // namespace threading
+} // namespace odex
+
+#endif // ODEX_THREADING_SHARED_POOL_HPP
@@ -0,0 +1,93 @@
+
+#ifndef ODEX_THREADING_TEAM_HPP
+#define ODEX_THREADING_TEAM_HPP
+
+#include "odex/threading/pool.hpp"
+#include "odex/threading/executor.hpp"
+#include "odex/threading/wait_policy.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <memory>
+
+namespace odex {
+namespace threading {
+
+/// Team of threads that splits loops of a single system evaluation.  The
+/// thread that owns the team is its first member and calls parallel_for();
+/// the remaining members are helper threads that sleep between loops.  An
+/// extrapolation_stepper hands each partition a team, so a system that
+/// accepts one can spread its stencil loops across cores that would
+/// otherwise idle, in addition to the parallelism across time steppers.
+class team
+{
+    team(team const&) = delete;
+public:
+    /// Construct a team of size threads, including the calling thread.  The
+    /// size-1 helper threads are pinned to cpus as in threading::pool.
+    explicit team(std::size_t size, wait_policy policy = wait_policy::blocking(),
+                  std::vector<int> cpus = std::vector<int>())
+    : m_size(std::max<std::size_t>(size, 1))
+    , m_pool(m_size-1, policy, std::move(cpus))
+    , m_task(nullptr)
+    {
+        auto target = [this](std::size_t index)
+        {
+            (*m_task)(index);
+        };
+        for (std::size_t ii = 1; ii < m_size; ++ii)
+        {
+            m_pool.emplace(ii-1, target, ii);
+        }
+    }
+
+    /// Number of threads in the team, including the owning thread.
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    /// Split [begin, end) into one contiguous chunk per team member and call
+    /// function(chunk_begin, chunk_end) for each non-empty chunk.  Returns
+    /// once all chunks are done.  Must be called from the owning thread.
+    template <class Function>
+    void parallel_for(std::size_t begin, std::size_t end, Function&& function)
+    {
+        auto const count = end > begin ? end-begin : 0;
+        auto const size = m_size;
+        auto chunk = [&function, begin, count, size](std::size_t index)
+        {
+            auto first = begin+count*index/size;
+            auto last = begin+count*(index+1)/size;
+            if (first < last)
+            {
+                function(first, last);
+            }
+        };
+
+        if (size == 1 || count < 2)
+        {
+            chunk(0);
+            for (std::size_t ii = 1; ii < size; ++ii)
+            {
+                chunk(ii);
+            }
+            return;
+        }
+
+        task_ref task(chunk);
+        m_task = &task;
+        m_pool.process([&chunk]{ chunk(0); });
+        m_task = nullptr;
+    }
+
+private:
+    std::size_t const m_size;
+    pool m_pool;
+    task_ref const* m_task;
+};
+
+} // namespace threading
+} // namespace odex
+
+#endif // ODEX_THREADING_TEAM_HPP
@@ -0,0 +1,57 @@
+
+#ifndef ODEX_THREADING_WAIT_POLICY_HPP
+#define ODEX_THREADING_WAIT_POLICY_HPP
+
+#include <cstddef>
+#include <thread>
+
+namespace odex {
+namespace threading {
+
+/// Describes how a thread waits for a signal from another thread.  The waiter
+/// polls for up to spin_count iterations before falling back to blocking on
+/// the operating system.  Spinning trades idle cpu time for wake-up latency,
+/// which pays off when the work between signals is short, e.g. small systems
+/// stepped by the extrapolation_stepper.  A spin_count of zero blocks right
+/// away.
+struct wait_policy
+{
+    /// Number of polling iterations before blocking
+    std::size_t spin_count;
+
+    /// Block immediately without polling.
+    static constexpr wait_policy blocking()
+    {
+        return wait_policy{0};
+    }
+
+    /// Poll for spin_count iterations before blocking.
+    static constexpr wait_policy spinning(std::size_t spin_count = 1 << 14)
+    {
+        return wait_policy{spin_count};
+    }
+};
+
+/// Back off the processor for one iteration of a spin loop.  Periodically
+/// yield so that an oversubscribed machine can still schedule the thread we
+/// are waiting on.
+inline void spin_pause(std::size_t iteration)
+{
+    if ((iteration & 63) == 63)
+    {
+        std::this_thread::yield();
+    }
+    else
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+}
+
+} // namespace threading
+} // namespace odex
+
+#endif // ODEX_THREADING_WAIT_POLICY_HPP
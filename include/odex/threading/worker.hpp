@@ -2,7 +2,11 @@
 #ifndef ODEX_THREADING_WORKER_HPP
 #define ODEX_THREADING_WORKER_HPP
 
-#include "odex/threading/semaphore.hpp"
+#include "odex/threading/wait_policy.hpp"
+#include "odex/threading/affinity.hpp"
+#include "odex/threading/epoch.hpp"
+#include <type_traits>
+#include <cstdint>
 #include <utility>
 #include <atomic>
 #include <thread>
@@ -11,8 +15,12 @@ namespace odex {
 namespace threading {
 
 /// Worker thread that waits for notification before processing data.  The
-/// worker has its target load attached at construction, and will call this
-/// each time notify() is called, then go back to waiting on a semaphore.
+/// worker has its target load attached at construction and waits on an epoch
+/// between calls.  The target runs at least once after each notify(), but
+/// notifies that arrive before the worker wakes are merged into one call, so
+/// callers must not count on one call per notify().  The wait_policy
+/// decides whether the worker spins before blocking while idle, and the
+/// worker may be pinned to a cpu for its whole lifetime.
 /// When passing function and arguments to the worker thread, copies are made
 /// to avoid storing references to stack data that gets destroyed after function
 /// exit.  To pass function object and arguments via reference, wrap the 
@@ -26,10 +34,24 @@ public:
     /// access on objects allocated on the caller's stack.  Use std::ref() to
     /// pass by reference if no copies are desired.
     template <class Function, class... Args, 
-              class = std::enable_if_t<!std::is_same<std::decay_t<Function>, worker>{}>>
+              class = std::enable_if_t<!std::is_same<std::decay_t<Function>, worker>{} &&
+                                       !std::is_same<std::decay_t<Function>, wait_policy>{}>>
     explicit worker(Function&& function, Args&&... args)
+    : worker(wait_policy::blocking(), -1, std::forward<Function>(function), std::forward<Args>(args)...)
+    {
+
+    }
+
+    /// Construct the worker with a wait policy, function and arguments.  The
+    /// worker thread pins itself to cpu before doing anything else, so memory
+    /// it first touches is placed on that cpu's NUMA node.  A negative cpu
+    /// leaves the thread unpinned.
+    template <class Function, class... Args>
+    explicit worker(wait_policy policy, int cpu, Function&& function, Args&&... args)
     : m_exit_flag(false)
-    , m_semaphore()
+    , m_policy(policy)
+    , m_cpu(cpu)
+    , m_epoch()
     , m_thread(_make_target(std::forward<Function>(function), std::forward<Args>(args)...))
     {
 
@@ -41,10 +63,11 @@ public:
         join();
     }
 
-    /// Notify the worker that data is ready to be processed.
+    /// Notify the worker that data is ready to be processed.  Merges with any
+    /// notify the worker has not yet woken for.
     void notify()
     {
-        m_semaphore.notify();
+        m_epoch.advance();
     }
 
     /// Join the worker before destruction.
@@ -74,10 +97,16 @@ private:
     template <class Function, class... Args>
     void _run(Function&& function, Args&&... args)
     {
+        if (m_cpu >= 0)
+        {
+            pin_current_thread(m_cpu);
+        }
+
+        std::uint32_t seen = 0;
         while (true)
         {
             // Wait for notification
-            m_semaphore.wait();
+            seen = m_epoch.wait(seen, m_policy);
 
             // If exit signal, break from the loop
             if (m_exit_flag) break;
@@ -89,7 +118,9 @@ private:
 
 private:
     std::atomic<bool> m_exit_flag;
-    semaphore m_semaphore;
+    wait_policy const m_policy;
+    int const m_cpu;
+    epoch m_epoch;
     std::thread m_thread;
 };
 
@@ -12,17 +12,23 @@ set(ODEX_INCLUDE "${PROJECT_SOURCE_DIR}/include")
 # sources in hierarchy mirroring that of the odex include directory structure.
 file(GLOB ODEX_HEADERS_BASE "${ODEX_INCLUDE}/odex/*.hpp")
 file(GLOB ODEX_HEADERS_STEPPERS "${ODEX_INCLUDE}/odex/steppers/*.hpp")
+file(GLOB ODEX_HEADERS_ALGEBRA "${ODEX_INCLUDE}/odex/algebra/*.hpp")
+file(GLOB ODEX_HEADERS_MEMORY "${ODEX_INCLUDE}/odex/memory/*.hpp")
 file(GLOB ODEX_HEADERS_OBSERVERS "${ODEX_INCLUDE}/odex/observers/*.hpp")
 file(GLOB ODEX_HEADERS_THREADING "${ODEX_INCLUDE}/odex/threading/*.hpp")
 file(GLOB ODEX_HEADERS_DETAIL "${ODEX_INCLUDE}/odex/detail/*.hpp")
 source_group(odex FILES ${ODEX_HEADERS_BASE})
 source_group(odex\\steppers FILES ${ODEX_HEADERS_STEPPERS})
+source_group(odex\\algebra FILES ${ODEX_HEADERS_ALGEBRA})
+source_group(odex\\memory FILES ${ODEX_HEADERS_MEMORY})
 source_group(odex\\observers FILES ${ODEX_HEADERS_OBSERVERS})
 source_group(odex\\threading FILES ${ODEX_HEADERS_THREADING})
 source_group(odex\\detail FILES ${ODEX_HEADERS_DETAIL})
 add_custom_target(odex_sources SOURCES
     ${ODEX_HEADERS_BASE}
     ${ODEX_HEADERS_STEPPERS}
+    ${ODEX_HEADERS_ALGEBRA}
+    ${ODEX_HEADERS_MEMORY}
     ${ODEX_HEADERS_OBSERVERS}
     ${ODEX_HEADERS_THREADING}
     ${ODEX_HEADERS_DETAIL}
@@ -0,0 +1,443 @@
+#ifdef NDEBUG
+#  undef NDEBUG
+#endif // NDEBUG
+
+// Eigen allocates with malloc rather than operator new.  With this defined
+// before Eigen is included, it asserts on any allocation while
+// Eigen::internal::set_is_malloc_allowed(false) is in effect.
+#define EIGEN_RUNTIME_NO_MALLOC
+
+#include "odex/make_extrapolation_stepper.hpp"
+#include "odex/threading/shared_pool.hpp"
+#include "convector.hpp"
+#include "diffuser.hpp"
+#include "matrix.hpp"
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <new>
+
+// gcc pairs the free() below with operator new once both are inlined into
+// the same caller, and wrongly reports them as mismatched
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+/// Number of calls to operator new while counting is enabled, from any thread,
+/// and the number of those that were of state_bytes bytes.
+static std::atomic<std::size_t> allocations(0);
+static std::atomic<std::size_t> state_allocations(0);
+static std::atomic<std::size_t> state_bytes(0);
+static std::atomic<bool> counting(false);
+
+void* operator new(std::size_t size)
+{
+    if (counting.load(std::memory_order_relaxed))
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        if (size == state_bytes.load(std::memory_order_relaxed))
+        {
+            state_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    operator delete[](ptr);
+}
+
+/// Step once to let the stepper size its buffers, then count the heap
+/// allocations made by the following steps.
+template <class ExStepper, class State>
+static std::size_t count_step_allocations(ExStepper& exstepper, State& y)
+{
+    exstepper.step(y, 0.0, 1e-5, std::size_t(1));
+
+    allocations = 0;
+    counting = true;
+    Eigen::internal::set_is_malloc_allowed(false);
+    exstepper.step(y, 1e-5, 1e-5, std::size_t(4));
+    Eigen::internal::set_is_malloc_allowed(true);
+    counting = false;
+    return allocations;
+}
+
+/// Options for each execution configuration of the stepper.  Arena placement
+/// only applies to states that keep their elements inline.
+template <class State>
+static std::vector<std::pair<char const*, odex::extrapolation_options>> configurations()
+{
+    std::vector<std::pair<char const*, odex::extrapolation_options>> configs;
+    configs.emplace_back("default", odex::extrapolation_options());
+
+    odex::extrapolation_options options;
+    options.wait = odex::threading::wait_policy::spinning();
+    configs.emplace_back("spinning", options);
+
+    options = odex::extrapolation_options();
+    options.scheduling = odex::scheduling::dynamic;
+    configs.emplace_back("dynamic", options);
+
+    options = odex::extrapolation_options();
+    options.executor = std::make_shared<odex::threading::shared_pool>(2);
+    configs.emplace_back("executor", options);
+
+    options = odex::extrapolation_options();
+    options.combine_grain = 1;
+    configs.emplace_back("split combination", options);
+
+    options = odex::extrapolation_options();
+    options.combination = odex::combination::streaming;
+    configs.emplace_back("streaming", options);
+
+    options = odex::extrapolation_options();
+    options.combination = odex::combination::accumulated;
+    configs.emplace_back("accumulated", options);
+
+    options = odex::extrapolation_options();
+    options.summation = odex::algebra::summation::compensated;
+    configs.emplace_back("compensated", options);
+
+    options = odex::extrapolation_options();
+    options.team_size = 2;
+    configs.emplace_back("team", options);
+
+    options = odex::extrapolation_options();
+    options.share_derivative = true;
+    configs.emplace_back("shared derivative", options);
+
+    if constexpr (odex::algebra::is_inline_v<State>)
+    {
+        options.arena = true;
+        configs.emplace_back("shared derivative in arena", options);
+
+        options = odex::extrapolation_options();
+        options.arena = true;
+        configs.emplace_back("arena", options);
+
+        options.combination = odex::combination::streaming;
+        configs.emplace_back("streaming in arena", options);
+    }
+
+    return configs;
+}
+
+/// Count the allocations made by the extrapolation stepper of the given time
+/// stepper on the system in every execution configuration, serial and
+/// parallel, and check that there are none.
+template <template <class> class Stepper, class System, class State>
+static void check_allocations(char const* name, System const& system, State const& y0, std::size_t order,
+                              std::size_t cores)
+{
+    for (auto const& config : configurations<State>())
+    {
+        for (bool parallel : { false, true })
+        {
+            auto exstepper = odex::make_extrapolation_stepper<Stepper>(system, y0, order, cores, parallel, config.second);
+            State y = y0;
+            auto count = count_step_allocations(exstepper, y);
+            std::cout << name << ", " << config.first << (parallel ? ", parallel" : ", serial")
+                      << ": " << count << " allocations" << std::endl;
+            assert(count == 0);
+        }
+    }
+}
+
+static void test_scalar_allocations()
+{
+    auto system = [](double, double y)
+    {
+        return y;
+    };
+    check_allocations<odex::steppers::gbs>("scalar state", system, 1.0, 8, 6);
+}
+
+static void test_matrix_allocations()
+{
+    constexpr std::size_t npoints = 32;
+    using state_type = matrix<double, npoints, npoints>;
+    using system_type = convector<double, state_type>;
+
+    system_type system(1, 0.5, 0.25);
+    state_type u0;
+    u0.setRandom();
+
+    check_allocations<odex::steppers::gbs>("matrix state", system, u0, 8, 6);
+    check_allocations<odex::steppers::compact_gbs>("compact stepper", system, u0, 8, 6);
+    check_allocations<odex::steppers::midpoint>("midpoint stepper", system, u0, 8, 3);
+
+    using fixed_type = Eigen::Matrix<double, 15, 15>;
+    convector<double, fixed_type> fixed_system(1, 0.5, 0.25);
+    fixed_type f0 = fixed_type::Random();
+    check_allocations<odex::steppers::gbs>("fixed size matrix state", fixed_system, f0, 8, 6);
+}
+
+static void test_stiff_allocations()
+{
+    constexpr std::size_t npoints = 63;
+    using state_type = matrix<double, npoints, 1>;
+
+    state_type u0;
+    u0.setRandom();
+
+    diffuser<double, state_type> system(1.0/double(npoints+1), 1, 1);
+    check_allocations<odex::steppers::linearly_implicit>("linearly implicit stepper", system, u0, 8, 3);
+
+    split_diffuser<double, state_type> split(npoints, 1, 1);
+    check_allocations<odex::steppers::imex>("imex stepper", split, u0, 8, 3);
+}
+
+static void test_arena()
+{
+    for (auto backing : { odex::memory::pages::standard, odex::memory::pages::transparent_huge, odex::memory::pages::huge })
+    {
+        odex::memory::arena arena(100, backing);
+        auto const page = odex::memory::arena::page_size(backing);
+        assert(arena.size() == page);
+        assert(reinterpret_cast<std::uintptr_t>(arena.data())%odex::memory::arena::page_size(arena.backing()) == 0);
+        // explicit huge pages fall back to transparent ones when none are reserved
+        assert(backing == odex::memory::pages::huge || arena.backing() == backing);
+
+        auto* first = arena.allocate(1);
+        auto* second = arena.allocate(8);
+        assert(reinterpret_cast<std::uintptr_t>(second)%odex::memory::arena::alignment == 0);
+        assert(static_cast<unsigned char*>(second)-static_cast<unsigned char*>(first) == odex::memory::arena::alignment);
+        assert(arena.used() == odex::memory::arena::alignment+8);
+
+        bool exhausted = false;
+        try
+        {
+            arena.allocate(page);
+        }
+        catch (std::bad_alloc const&)
+        {
+            exhausted = true;
+        }
+        assert(exhausted);
+    }
+}
+
+/// Range of the arena the placed_stepper checks its buffers against, and the
+/// number of buffers it found inside and outside of it.
+static unsigned char const* arena_first = nullptr;
+static unsigned char const* arena_last = nullptr;
+static std::atomic<std::size_t> placed(0);
+static std::atomic<std::size_t> misplaced(0);
+
+/// Count the state as placed if its elements lie in the arena.
+template <class State>
+static void check_placement(State const& state)
+{
+    using traits = odex::algebra::contiguous_traits<State>;
+    auto const* first = reinterpret_cast<unsigned char const*>(traits::data(state));
+    auto const* last = reinterpret_cast<unsigned char const*>(traits::data(state)+traits::size(state));
+    ++(first >= arena_first && last <= arena_last ? placed : misplaced);
+}
+
+/// Time stepper that checks that its output, derivative and scratch are in
+/// the arena before stepping.  It hides the step_accumulate() of the wrapped
+/// stepper, so that accumulated combination goes through a partition output.
+template <class Stepper>
+struct placed_stepper
+{
+    using scratch_type = typename Stepper::scratch_type;
+
+    template <class System, class State, class Time, class Subintervals>
+    static void step(System&& system, State const& y0, State& y, Time t, Time dt, Subintervals n,
+                     State const& fval0, scratch_type& scratch)
+    {
+        check_placement(y);
+        check_placement(fval0);
+        for (auto const& state : scratch)
+        {
+            check_placement(state);
+        }
+        Stepper::step(std::forward<System>(system), y0, y, t, dt, n, fval0, scratch);
+    }
+};
+
+static void test_arena_stepper()
+{
+    using state_type = Eigen::Matrix<double, 15, 15>;
+    using system_type = convector<double, state_type>;
+    using stepper_type = placed_stepper<odex::steppers::gbs<state_type>>;
+    using exstepper_type = odex::extrapolation_stepper<system_type, stepper_type, state_type, double>;
+
+    system_type system(1, 0.5, 0.25);
+    state_type u0 = state_type::Random();
+    auto config = odex::detail::make_extrap_config<double>(8, 6);
+    auto const& step_counts = std::get<1>(config);
+    auto const& weights = std::get<2>(config);
+
+    for (bool parallel : { false, true })
+    {
+        for (auto combination : { odex::combination::deferred, odex::combination::streaming,
+                                  odex::combination::accumulated })
+        {
+            odex::extrapolation_options options;
+            options.combination = combination;
+            auto on_heap = odex::make_extrapolation_stepper(system, u0, 8, 6, parallel, options);
+            assert(on_heap.arena_size() == 0);
+            assert(on_heap.arena_data() == nullptr);
+
+            options.arena = true;
+            exstepper_type in_arena(stepper_type(), system, step_counts.size(), step_counts.begin(),
+                                    weights.begin(), 8, std::get<0>(config), parallel, options);
+            assert(in_arena.arena_size() > 0);
+
+            // every buffer the steppers touch lies in the arena
+            arena_first = in_arena.arena_data();
+            arena_last = arena_first+in_arena.arena_size();
+            placed = 0;
+            misplaced = 0;
+
+            state_type u = u0;
+            state_type v = u0;
+            in_arena.step(u, 0.0, 1e-5, std::size_t(10));
+            on_heap.step(v, 0.0, 1e-5, std::size_t(10));
+            assert(placed > 0);
+            assert(misplaced == 0);
+            assert((u-v).norm() <= 1e-12*v.norm());
+        }
+    }
+
+    // states that keep their elements on the heap are rejected
+    static_assert(!odex::algebra::is_inline_v<matrix<double, 16, 16>>, "matrix keeps its elements on the heap");
+    odex::extrapolation_options options;
+    options.arena = true;
+    bool rejected = false;
+    try
+    {
+        matrix<double, 16, 16> m0;
+        odex::make_extrapolation_stepper(convector<double, matrix<double, 16, 16>>(1, 0.5, 0.25), m0, 8, 6,
+                                         true, options);
+    }
+    catch (std::invalid_argument const&)
+    {
+        rejected = true;
+    }
+    assert(rejected);
+}
+
+/// Decay system dy_i/dt = -(i+1)*y_i over std::vector, evaluated in place.
+struct vector_decay
+{
+    void operator()(double, std::vector<double> const& y, std::vector<double>& dydt) const
+    {
+        dydt.resize(y.size());
+        for (std::size_t ii = 0; ii < y.size(); ++ii)
+        {
+            dydt[ii] = -static_cast<double>(ii+1)*y[ii];
+        }
+    }
+};
+
+/// Number of std::vector states the extrapolation stepper of the given time
+/// stepper allocates, over its construction and first step.  Every state is
+/// sized on the first step, so this counts them all.
+template <template <class> class Stepper>
+static std::size_t count_states(std::vector<double> const& y0, std::size_t order, std::size_t cores,
+                                odex::combination combination)
+{
+    odex::extrapolation_options options;
+    options.combination = combination;
+
+    state_bytes = y0.size()*sizeof(double);
+    state_allocations = 0;
+    counting = true;
+    {
+        auto exstepper = odex::make_extrapolation_stepper<Stepper>(vector_decay{}, y0, order, cores, true, options);
+        std::vector<double> y = y0;
+        exstepper.step(y, 0.0, 1e-5, std::size_t(1));
+    }
+    counting = false;
+    return state_allocations;
+}
+
+/// Report the output states held under deferred and accumulated combination,
+/// with a time stepper that accumulates by itself and with one that steps
+/// into an output per partition of several steppers.
+static void test_output_memory()
+{
+    std::vector<double> y0(1031, 1.0);
+    std::vector<std::array<std::size_t,2>> configs = { {8,3}, {8,8}, {12,8} };
+    for (auto const& config : configs)
+    {
+        auto const order = config[0];
+        auto const cores = config[1];
+        auto const step_counts = std::get<1>(odex::detail::make_extrap_config<double>(order, cores));
+        auto const steppers = step_counts.size();
+        auto const groups = odex::detail::partition(step_counts.begin(), steppers);
+        auto const partitions = groups.size();
+
+        // a partition of several steppers steps into an output besides its sum
+        std::size_t compact_expected = 0;
+        for (auto const& group : groups)
+        {
+            compact_expected += group.size() == 1 ? 1 : 2;
+        }
+
+        // the other states are the same whatever the combination, so the
+        // difference in states is the difference in output states
+        auto const deferred = count_states<odex::steppers::gbs>(y0, order, cores, odex::combination::deferred);
+        auto const summed = count_states<odex::steppers::gbs>(y0, order, cores, odex::combination::accumulated);
+        auto const compact_deferred = count_states<odex::steppers::compact_gbs>(y0, order, cores,
+                                                                               odex::combination::deferred);
+        auto const compact_summed = count_states<odex::steppers::compact_gbs>(y0, order, cores,
+                                                                             odex::combination::accumulated);
+        auto const summed_outputs = steppers+summed-deferred;
+        auto const compact_outputs = steppers+compact_summed-compact_deferred;
+        std::cout << "GBS_{" << order << "," << cores << "} output states: deferred " << steppers
+                  << ", accumulated " << summed_outputs << " with gbs, " << compact_outputs
+                  << " with compact_gbs and an in place system" << std::endl;
+
+        assert(summed_outputs == partitions);
+        assert(compact_outputs == compact_expected);
+
+        // summing never takes more output memory than storing every output
+        assert(summed_outputs <= steppers);
+        assert(compact_outputs <= steppers);
+    }
+}
+
+int main()
+{
+    test_arena();
+    test_arena_stepper();
+    test_scalar_allocations();
+    test_matrix_allocations();
+    test_stiff_allocations();
+    test_output_memory();
+}
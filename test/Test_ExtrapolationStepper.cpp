@@ -6,16 +6,31 @@
 #include "odex/integrate.hpp"
 #include "odex/extrapolation_stepper.hpp"
 #include "odex/steppers/gbs.hpp"
+#include "odex/steppers/compact_gbs.hpp"
+#include "odex/steppers/midpoint.hpp"
+#include "odex/steppers/linearly_implicit.hpp"
+#include "odex/steppers/imex.hpp"
+#include "odex/observers/async_observer.hpp"
 #include "convector.hpp"
+#include "diffuser.hpp"
+#include "transport.hpp"
 #include "matrix.hpp"
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 #include <vector>
 #include <chrono>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <future>
+#include <valarray>
+#include <complex>
 #include <array>
 #include <cmath>
 
-static void run_simple_ode(std::size_t order, std::size_t num_cores, bool parallel, bool print)
+static void run_simple_ode(std::size_t order, std::size_t num_cores, bool parallel, bool print,
+                           odex::extrapolation_options const& options = odex::extrapolation_options())
 {
     using state_type = double;
     using time_type = double;
@@ -33,7 +48,7 @@ static void run_simple_ode(std::size_t order, std::size_t num_cores, bool parall
     std::vector<state_type> output(nsteps+1, state_type{});
     state_type y0 = std::exp(t0);
     state_type y  = odex::integrate(system, y0, t0, dt, nsteps, odex::observers::null_observer{},
-                                    order, num_cores, parallel);
+                                    order, num_cores, parallel, options);
 
     auto error = std::exp(t1)-y;
     if (print)
@@ -57,6 +72,67 @@ static void test_simple_ode()
         run_simple_ode(order, cores, true,  true);
     }
 
+    // Spin-then-block dispatch must produce identical results
+    odex::extrapolation_options spinning;
+    spinning.wait = odex::threading::wait_policy::spinning();
+    for (std::size_t ii = 0; ii < configs.size(); ++ii)
+    {
+        run_simple_ode(configs[ii][0], configs[ii][1], true, false, spinning);
+    }
+
+    // Dynamically scheduled steppers
+    odex::extrapolation_options dynamic;
+    dynamic.scheduling = odex::scheduling::dynamic;
+    for (std::size_t ii = 0; ii < configs.size(); ++ii)
+    {
+        run_simple_ode(configs[ii][0], configs[ii][1], true, false, dynamic);
+    }
+
+    // Partitions submitted to the process-wide executor
+    odex::extrapolation_options shared;
+    shared.executor = odex::threading::default_executor();
+    for (std::size_t ii = 0; ii < configs.size(); ++ii)
+    {
+        run_simple_ode(configs[ii][0], configs[ii][1], true, false, shared);
+    }
+
+    // Many steppers stepping at once on one small executor
+    shared.executor = std::make_shared<odex::threading::shared_pool>(2);
+    std::vector<std::thread> threads;
+    for (std::size_t ii = 0; ii < 8; ++ii)
+    {
+        threads.emplace_back([&shared]{ run_simple_ode(8, 6, true, false, shared); });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Partitions folded into the result as soon as they finish
+    odex::extrapolation_options streaming;
+    streaming.combination = odex::combination::streaming;
+    for (std::size_t ii = 0; ii < configs.size(); ++ii)
+    {
+        run_simple_ode(configs[ii][0], configs[ii][1], true, false, streaming);
+    }
+
+    // Weighted outputs summed per partition in place of being stored
+    odex::extrapolation_options accumulated;
+    accumulated.combination = odex::combination::accumulated;
+    for (std::size_t ii = 0; ii < configs.size(); ++ii)
+    {
+        run_simple_ode(configs[ii][0], configs[ii][1], false, false, accumulated);
+        run_simple_ode(configs[ii][0], configs[ii][1], true, false, accumulated);
+    }
+
+    // Pinned workers with their buffers allocated in place
+    odex::extrapolation_options pinned;
+    pinned.placement = odex::threading::affinity::scatter();
+    for (std::size_t ii = 0; ii < configs.size(); ++ii)
+    {
+        run_simple_ode(configs[ii][0], configs[ii][1], true, false, pinned);
+    }
+
 
     // Bang on the threading synchronization
     std::size_t order = 8;
@@ -121,6 +197,927 @@ static double run_convection_2d(std::size_t order, std::size_t cores, bool paral
     return duration;
 }
 
+/// Number of evaluations of a system through each of its protocols.
+struct protocol_counts
+{
+    std::atomic<std::size_t> returning{0};
+    std::atomic<std::size_t> in_place{0};
+    std::atomic<std::size_t> fused{0};
+    std::atomic<std::size_t> team{0};
+};
+
+/// System counting its evaluations through each protocol of the wrapped
+/// system, exposing exactly the protocols the wrapped system has.
+template <class System>
+struct counted_system
+{
+    template <class Time, class State, class... Args>
+    auto operator()(Time t, State const& y, Args&&... args)
+        -> decltype(std::declval<System&>()(t, y, std::forward<Args>(args)...))
+    {
+        constexpr bool team = (std::is_same<std::decay_t<Args>, odex::threading::team>::value || ...);
+        constexpr std::size_t arguments = sizeof...(Args)-(team ? 1 : 0);
+        ++(arguments == 0 ? m_counts->returning : arguments == 1 ? m_counts->in_place : m_counts->fused);
+        if (team)
+        {
+            ++m_counts->team;
+        }
+        return m_system(t, y, std::forward<Args>(args)...);
+    }
+
+    System m_system;
+    std::shared_ptr<protocol_counts> m_counts;
+};
+
+static void test_convection_team()
+{
+    constexpr std::size_t npoints = 32;
+    using value_type = double;
+    using state_type = matrix<value_type, npoints, npoints>;
+    using system_type = convector<value_type, state_type>;
+
+    system_type system(1, 0.5, 0.25);
+    state_type u0;
+    for (std::ptrdiff_t ii = 0; ii < ptrdiff_t(npoints); ++ii)
+    {
+        for (std::ptrdiff_t jj = 0; jj < ptrdiff_t(npoints); ++jj)
+        {
+            u0(ii,jj) = std::sin(0.1*double(ii))*std::cos(0.2*double(jj));
+        }
+    }
+
+    // evaluations through each protocol are counted into counts
+    auto run = [&](bool parallel, std::size_t team_size, protocol_counts& counts)
+    {
+        odex::extrapolation_options options;
+        options.team_size = team_size;
+        counted_system<system_type> counted{system, std::make_shared<protocol_counts>()};
+        auto exstepper = odex::make_extrapolation_stepper(counted, u0, 8, 3, parallel, options);
+        state_type u = u0;
+        exstepper.step(u, 0.0, 1e-5, std::size_t(8));
+        counts.returning = counted.m_counts->returning.load();
+        counts.in_place = counted.m_counts->in_place.load();
+        counts.fused = counted.m_counts->fused.load();
+        counts.team = counted.m_counts->team.load();
+        return u;
+    };
+
+    // splitting the system's loops across a team must not change the result
+    protocol_counts serial_counts, serial_team_counts, parallel_counts, parallel_team_counts;
+    state_type serial = run(false, 1, serial_counts);
+    state_type serial_team = run(false, 4, serial_team_counts);
+    assert(serial_team == serial);
+    state_type parallel = run(true, 1, parallel_counts);
+    state_type parallel_team = run(true, 3, parallel_team_counts);
+    assert(parallel_team == parallel);
+    assert(parallel == serial);
+
+    // nor which protocols are evaluated: every evaluation is handed the team
+    // and goes through the in-place or fused overloads, none returns a state
+    for (auto const* counts : { &serial_counts, &serial_team_counts, &parallel_counts, &parallel_team_counts })
+    {
+        assert(counts->returning == 0);
+        assert(counts->in_place > 0);
+        assert(counts->fused > 0);
+        assert(counts->team == counts->in_place+counts->fused);
+    }
+    assert(serial_team_counts.in_place == serial_counts.in_place);
+    assert(serial_team_counts.fused == serial_counts.fused);
+    assert(parallel_team_counts.in_place == parallel_counts.in_place);
+    assert(parallel_team_counts.fused == parallel_counts.fused);
+}
+
+/// Time stepper that only stores its result, hiding the step_accumulate() of
+/// the wrapped stepper.
+template <class Stepper>
+struct storing_stepper
+{
+    using scratch_type = typename Stepper::scratch_type;
+
+    template <class... Args>
+    static void step(Args&&... args)
+    {
+        Stepper::step(std::forward<Args>(args)...);
+    }
+};
+
+/// System that only returns its time derivative, hiding the in-place
+/// overload of the wrapped system.
+template <class System>
+struct returning_system
+{
+    template <class Time, class State>
+    auto operator()(Time t, State const& y)
+    {
+        return m_system(t, y);
+    }
+
+    System m_system;
+};
+
+/// System that only evaluates in place, hiding the fused overload of the
+/// wrapped system.
+template <class System>
+struct in_place_system
+{
+    template <class Time, class State>
+    auto operator()(Time t, State const& y)
+    {
+        return m_system(t, y);
+    }
+
+    template <class Time, class State>
+    void operator()(Time t, State const& y, State& dydt)
+    {
+        m_system(t, y, dydt);
+    }
+
+    System m_system;
+};
+
+static void test_system_protocols()
+{
+    constexpr std::size_t npoints = 32;
+    using value_type = double;
+    using state_type = matrix<value_type, npoints, npoints>;
+    using system_type = convector<value_type, state_type>;
+
+    static_assert(odex::detail::evaluates_fused<system_type, double, state_type>::value,
+                  "convector must be detected as fusing its update");
+    static_assert(odex::detail::evaluates_in_place<system_type, double, state_type>::value,
+                  "convector must be detected as evaluating in place");
+    static_assert(!odex::detail::evaluates_fused<in_place_system<system_type>, double, state_type>::value,
+                  "in_place_system must not be detected as fusing its update");
+    static_assert(!odex::detail::evaluates_in_place<returning_system<system_type>, double, state_type>::value,
+                  "returning_system must not be detected as evaluating in place");
+
+    system_type system(1, 0.5, 0.25);
+    state_type u0;
+    for (std::ptrdiff_t ii = 0; ii < ptrdiff_t(npoints); ++ii)
+    {
+        for (std::ptrdiff_t jj = 0; jj < ptrdiff_t(npoints); ++jj)
+        {
+            u0(ii,jj) = std::sin(0.1*double(ii))*std::cos(0.2*double(jj));
+        }
+    }
+
+    // evaluations through each protocol are counted into counts
+    auto run = [&](auto const& current_system, bool parallel, protocol_counts& counts)
+    {
+        using current_type = std::decay_t<decltype(current_system)>;
+        auto shared_counts = std::make_shared<protocol_counts>();
+        counted_system<current_type> counted{current_system, shared_counts};
+        auto exstepper = odex::make_extrapolation_stepper(counted, u0, 8, 6, parallel);
+        state_type u = u0;
+        exstepper.step(u, 0.0, 1e-5, std::size_t(8));
+        counts.returning = shared_counts->returning.load();
+        counts.in_place = shared_counts->in_place.load();
+        counts.fused = shared_counts->fused.load();
+        counts.team = shared_counts->team.load();
+        return u;
+    };
+
+    // the steppers must take the richest protocol each system offers, also
+    // when the system accepts a team and is handed the partition's
+    auto check = [](protocol_counts const& counts, bool in_place, bool fused, bool team)
+    {
+        assert((counts.in_place > 0) == in_place);
+        assert((counts.fused > 0) == fused);
+        assert(counts.returning == 0 || !in_place);
+        assert(counts.team == (team ? counts.returning+counts.in_place+counts.fused : 0));
+    };
+
+    state_type serial_in_place, serial_fused;
+    for (bool parallel : { false, true })
+    {
+        protocol_counts in_place_counts, returned_counts, fused_counts;
+
+        // writing the derivative into the scratch must not change the result
+        state_type in_place = run(in_place_system<system_type>{system}, parallel, in_place_counts);
+        state_type returned = run(returning_system<system_type>{system}, parallel, returned_counts);
+        assert(in_place == returned);
+        check(in_place_counts, true, false, false);
+        check(returned_counts, false, false, false);
+        assert(returned_counts.returning > 0);
+
+        // nor must fusing the evaluation with the leap frog update, up to the
+        // contraction of the update into fused multiply-adds.  the derivative
+        // at the initial state is still evaluated in place
+        state_type fused = run(system, parallel, fused_counts);
+        assert((fused-in_place).norm() <= 1e-14*in_place.norm());
+        check(fused_counts, true, true, true);
+
+        if (!parallel)
+        {
+            serial_in_place = in_place;
+            serial_fused = fused;
+        }
+        assert(in_place == serial_in_place);
+        assert(fused == serial_fused);
+    }
+}
+
+/// Decay system dy_i/dt = -(i+1)*y_i, written with element access only so
+/// that it applies to any container.
+struct decay_system
+{
+    template <class State>
+    void operator()(double, State const& y, State& dydt) const
+    {
+        dydt = y;
+        for (std::size_t ii = 0; ii < std::size(y); ++ii)
+        {
+            dydt[ii] = -static_cast<double>(ii+1)*y[ii];
+        }
+    }
+};
+
+/// Step the decay system over a container state with the given number of
+/// elements, returning the result.
+template <class State>
+static State run_container(State y, bool parallel, odex::combination combination)
+{
+    odex::extrapolation_options options;
+    options.combination = combination;
+    auto exstepper = odex::make_extrapolation_stepper(decay_system{}, y, 8, 6, parallel, options);
+    exstepper.step(y, 0.0, 1e-2, std::size_t(10));
+    return y;
+}
+
+static void test_standard_containers()
+{
+    constexpr std::size_t size = 5;
+    std::vector<double> y0(size, 1.0);
+    std::valarray<double> v0(1.0, size);
+    std::array<double, size> a0;
+    a0.fill(1.0);
+
+    // none of these have the operators the steppers used to require, and
+    // all go through the same kernels
+    for (bool parallel : { false, true })
+    {
+        for (auto combination : { odex::combination::deferred, odex::combination::accumulated })
+        {
+            auto y = run_container(y0, parallel, combination);
+            auto v = run_container(v0, parallel, combination);
+            auto a = run_container(a0, parallel, combination);
+            for (std::size_t ii = 0; ii < size; ++ii)
+            {
+                auto const exact = std::exp(-0.1*static_cast<double>(ii+1));
+                assert(std::abs(y[ii]-exact) < 1e-12*exact);
+                assert(v[ii] == y[ii]);
+                assert(a[ii] == y[ii]);
+            }
+        }
+    }
+
+    // systems may also return a std::vector
+    auto returning = [](double, std::vector<double> const& y)
+    {
+        std::vector<double> dydt(y.size());
+        decay_system{}(0.0, y, dydt);
+        return dydt;
+    };
+    auto exstepper = odex::make_extrapolation_stepper(returning, y0, 8, 6, false);
+    auto y = y0;
+    exstepper.step(y, 0.0, 1e-2, std::size_t(10));
+    assert(y == run_container(y0, false, odex::combination::deferred));
+}
+
+/// Exponential growth system counting its evaluations across all copies.
+struct counting_system
+{
+    double operator()(double, double y) const
+    {
+        ++*m_evaluations;
+        return y;
+    }
+
+    std::shared_ptr<std::atomic<std::size_t>> m_evaluations;
+};
+
+static void test_shared_derivative()
+{
+    // evaluations per step, after a first step that sizes the buffers
+    auto evaluations = [](bool parallel, odex::extrapolation_options const& options, double& y)
+    {
+        counting_system system{std::make_shared<std::atomic<std::size_t>>(0)};
+        auto exstepper = odex::make_extrapolation_stepper(system, 1.0, 8, 6, parallel, options);
+        y = 1;
+        exstepper.step(y, 0.0, 1e-2, std::size_t(1));
+        *system.m_evaluations = 0;
+        exstepper.step(y, 1e-2, 1e-2, std::size_t(1));
+        return system.m_evaluations->load();
+    };
+
+    double serial = 0;
+    auto const serial_evaluations = evaluations(false, odex::extrapolation_options(), serial);
+    auto const step_counts = std::get<1>(odex::detail::make_extrap_config<double>(8, 6));
+    auto const partitions = odex::detail::partition(step_counts.begin(), step_counts.size()).size();
+
+    for (auto scheduling : { odex::scheduling::static_partition, odex::scheduling::dynamic })
+    {
+        odex::extrapolation_options options;
+        options.scheduling = scheduling;
+        double separate = 0;
+        auto const separate_evaluations = evaluations(true, options, separate);
+
+        options.share_derivative = true;
+        double shared = 0;
+        auto const shared_evaluations = evaluations(true, options, shared);
+
+        std::cout << "system evaluations per step: " << separate_evaluations << " separate, "
+                  << shared_evaluations << " shared, " << serial_evaluations << " serial" << std::endl;
+
+        // the shared derivative is evaluated once, like the serial stepper's,
+        // in place of once per partition.  with dynamic scheduling only
+        // threads that claim a stepper evaluate their own, so there may be as
+        // few as one
+        assert(shared_evaluations == serial_evaluations);
+        assert(separate_evaluations-shared_evaluations == partitions-1 ||
+               scheduling == odex::scheduling::dynamic);
+        assert(shared == separate);
+        assert(shared == serial);
+    }
+}
+
+static void test_compact_gbs()
+{
+    constexpr std::size_t npoints = 32;
+    using value_type = double;
+    using state_type = matrix<value_type, npoints, npoints>;
+    using system_type = convector<value_type, state_type>;
+
+    static_assert(sizeof(odex::steppers::compact_gbs<std::array<double,64>>::scratch_type) ==
+                  2*sizeof(std::array<double,64>), "compact_gbs holds two iterates");
+    static_assert(!odex::detail::accumulates<odex::steppers::compact_gbs<state_type>, in_place_system<system_type>,
+                                             state_type, double, double>::value,
+                  "compact_gbs borrows the output of systems that evaluate in place");
+    static_assert(odex::detail::accumulates<odex::steppers::compact_gbs<state_type>, returning_system<system_type>,
+                                            state_type, double, double>::value,
+                  "compact_gbs accumulates systems that return their derivative");
+
+    system_type system(1, 0.5, 0.25);
+    state_type u0;
+    for (std::ptrdiff_t ii = 0; ii < ptrdiff_t(npoints); ++ii)
+    {
+        for (std::ptrdiff_t jj = 0; jj < ptrdiff_t(npoints); ++jj)
+        {
+            u0(ii,jj) = std::sin(0.1*double(ii))*std::cos(0.2*double(jj));
+        }
+    }
+
+    // the compact stepper agrees with gbs up to rounding whichever way the
+    // system is evaluated and the results are combined
+    auto compare = [&](auto const& current_system, bool parallel, odex::combination combination)
+    {
+        odex::extrapolation_options options;
+        options.combination = combination;
+        auto exstepper = odex::make_extrapolation_stepper(current_system, u0, 8, 6, parallel, options);
+        auto compact = odex::make_extrapolation_stepper<odex::steppers::compact_gbs>(current_system, u0, 8, 6,
+                                                                                     parallel, options);
+        state_type u = u0;
+        state_type v = u0;
+        exstepper.step(u, 0.0, 1e-3, std::size_t(20));
+        compact.step(v, 0.0, 1e-3, std::size_t(20));
+        assert((u-v).norm() <= 1e-12*u.norm() && "compact_gbs differs from gbs!");
+    };
+    for (bool parallel : { false, true })
+    {
+        for (auto combination : { odex::combination::deferred, odex::combination::accumulated })
+        {
+            compare(system, parallel, combination);
+            compare(in_place_system<system_type>{system}, parallel, combination);
+            compare(returning_system<system_type>{system}, parallel, combination);
+        }
+    }
+
+    // and is as accurate on exponential growth, including single subinterval
+    // sequences
+    auto growth = [](double, double y)
+    {
+        return y;
+    };
+    for (auto order : { std::size_t(8), std::size_t(12) })
+    {
+        auto compact = odex::make_extrapolation_stepper<odex::steppers::compact_gbs>(growth, 1.0, order, 8, false);
+        double y = 1;
+        compact.step(y, 0.0, 1e-2, std::size_t(20));
+        assert(std::abs(y-std::exp(0.2)) < 1e-12 && "compact_gbs error too large!");
+    }
+    odex::steppers::compact_gbs<double>::scratch_type scratch;
+    double y = 0;
+    odex::steppers::compact_gbs<double>::step(growth, 1.0, y, 0.0, 0.1, std::size_t(1), 1.0, scratch);
+    assert(std::abs(y-(1+0.1*(1+0.5*0.1))) < 1e-15);
+
+    // per core memory and time per step of the two steppers on a mid-sized
+    // state, which the compact stepper keeps closer to the cache
+    using mid_state_type = matrix<value_type, 256, 256>;
+    convector<value_type, mid_state_type> mid_system(1, 0.5, 0.25);
+    mid_state_type w0 = mid_state_type::Random(256, 256);
+    auto time = [&](auto exstepper)
+    {
+        mid_state_type w = w0;
+        exstepper.step(w, 0.0, 1e-4, std::size_t(1));
+        auto begin_time = std::chrono::steady_clock::now();
+        exstepper.step(w, 1e-4, 1e-4, std::size_t(4));
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now()-begin_time).count()/4;
+    };
+    auto gbs_time = time(odex::make_extrapolation_stepper(mid_system, w0, 8, 3, false));
+    auto compact_time = time(odex::make_extrapolation_stepper<odex::steppers::compact_gbs>(mid_system, w0, 8, 3, false));
+    std::cout << "GBS_{8,3} on 256x256 convection: gbs " << gbs_time << " us/step with 3 scratch states, compact_gbs "
+              << compact_time << " us/step with 2" << std::endl;
+}
+
+static void test_midpoint()
+{
+    std::vector<std::array<std::size_t,2>> configs = { {8,3}, {12,4}, {16,5} };
+    auto const method = odex::detail::base_method::midpoint;
+
+    // the unsmoothed weights form consistent schemes of the requested order
+    for (auto const& config : configs)
+    {
+        auto weights = std::get<2>(odex::detail::make_extrap_config<double>(config[0], config[1], method));
+        double sum = 0;
+        for (auto weight : weights)
+        {
+            sum += weight;
+        }
+        assert(std::abs(sum-1) < 1e-10 && weights.size() == config[0]/2);
+
+        auto growth = [](double, double y)
+        {
+            return y;
+        };
+        for (bool parallel : { false, true })
+        {
+            auto exstepper = odex::make_extrapolation_stepper<odex::steppers::midpoint>(growth, 1.0, config[0], config[1],
+                                                                                        parallel);
+            double y = 1;
+            exstepper.step(y, 0.0, 1e-2, std::size_t(20));
+            assert(std::abs(y-std::exp(0.2)) < 1e-12 && "midpoint error too large!");
+        }
+    }
+
+    // a step of the oscillator y' = i*y never grows inside the imaginary
+    // stability boundary, normalized by the largest step count
+    auto oscillator = [](double, std::complex<double> y)
+    {
+        return std::complex<double>(0, 1)*y;
+    };
+    for (auto const& config : configs)
+    {
+        auto exstepper = odex::make_extrapolation_stepper<odex::steppers::midpoint>(oscillator, std::complex<double>(1),
+                                                                                    config[0], config[1], false);
+        auto step_counts = std::get<1>(odex::detail::make_extrap_config<double>(config[0], config[1], method));
+        auto const boundary = double(exstepper.isbn())*double(*std::max_element(step_counts.begin(), step_counts.end()));
+        for (double fraction = 0.01; fraction < 1; fraction += 0.01)
+        {
+            std::complex<double> y = 1;
+            exstepper.step(y, 0.0, fraction*boundary, std::size_t(1));
+            assert(std::abs(y) <= 1+1e-10 && "midpoint unstable inside its stability boundary!");
+        }
+    }
+
+    // agrees with gbs on convection whichever way the system is evaluated
+    constexpr std::size_t npoints = 32;
+    using state_type = matrix<double, npoints, npoints>;
+    using system_type = convector<double, state_type>;
+    system_type system(1, 0.5, 0.25);
+    state_type u0 = state_type::Random(npoints, npoints);
+    auto compare = [&](auto const& current_system, bool parallel, odex::combination combination)
+    {
+        odex::extrapolation_options options;
+        options.combination = combination;
+        auto exstepper = odex::make_extrapolation_stepper(current_system, u0, 8, 3, parallel, options);
+        auto midpoint = odex::make_extrapolation_stepper<odex::steppers::midpoint>(current_system, u0, 8, 3,
+                                                                                   parallel, options);
+        state_type u = u0;
+        state_type v = u0;
+        exstepper.step(u, 0.0, 1e-3, std::size_t(20));
+        midpoint.step(v, 0.0, 1e-3, std::size_t(20));
+        assert((u-v).norm() <= 1e-9*u.norm() && "midpoint differs from gbs!");
+    };
+    for (bool parallel : { false, true })
+    {
+        for (auto combination : { odex::combination::deferred, odex::combination::accumulated })
+        {
+            compare(system, parallel, combination);
+            compare(in_place_system<system_type>{system}, parallel, combination);
+            compare(returning_system<system_type>{system}, parallel, combination);
+        }
+    }
+}
+
+/// System counting its Jacobian evaluations across all of its copies.
+template <class System>
+struct jacobian_counter : System
+{
+    using System::System;
+
+    template <class Time, class State, class Matrix>
+    void jacobian(Time t, State const& u, Matrix& J)
+    {
+        ++(*evaluations);
+        System::jacobian(t, u, J);
+    }
+
+    std::shared_ptr<std::atomic<std::size_t>> evaluations = std::make_shared<std::atomic<std::size_t>>(0);
+};
+
+static void test_band_matrix()
+{
+    // banded and dense factorizations of I - h*J solve the same system
+    std::size_t const n = 24;
+    odex::algebra::band_matrix<double> banded;
+    odex::algebra::band_matrix<double> dense;
+    banded.resize(n, 2, 3);
+    dense.resize(n);
+    for (std::size_t ii = 0; ii < n; ++ii)
+    {
+        for (std::size_t jj = ii > 2 ? ii-2 : 0; jj <= std::min(n-1, ii+3); ++jj)
+        {
+            auto value = std::sin(double(3*ii+7*jj+1));
+            banded(ii, jj) = value;
+            dense(ii, jj) = value;
+        }
+    }
+
+    // a large h makes the system far from diagonally dominant, so that rows
+    // are exchanged
+    odex::algebra::band_matrix<double> banded_lu;
+    odex::algebra::band_matrix<double> dense_lu;
+    banded_lu.factor(banded, 5.0);
+    dense_lu.factor(dense, 5.0);
+    std::vector<double> x(n), y(n), b(n);
+    for (std::size_t ii = 0; ii < n; ++ii)
+    {
+        b[ii] = std::cos(double(ii));
+    }
+    x = b;
+    y = b;
+    banded_lu.solve(x.data());
+    dense_lu.solve(y.data());
+    for (std::size_t ii = 0; ii < n; ++ii)
+    {
+        auto residual = x[ii];
+        for (std::size_t jj = ii > 2 ? ii-2 : 0; jj <= std::min(n-1, ii+3); ++jj)
+        {
+            residual -= 5.0*banded(ii, jj)*x[jj];
+        }
+        assert(std::abs(residual-b[ii]) < 1e-10 && "band matrix solve failed!");
+        assert(std::abs(x[ii]-y[ii]) < 1e-10 && "banded and dense solves differ!");
+    }
+}
+
+static void test_linearly_implicit()
+{
+    std::vector<std::array<std::size_t,2>> configs = { {4,2}, {6,2}, {8,3}, {12,3} };
+    auto const method = odex::detail::base_method::linearly_implicit;
+
+    // the weights form consistent schemes, which are accurate on non-stiff
+    // problems
+    struct decay
+    {
+        double operator()(double, double y) const
+        {
+            return -y;
+        }
+
+        void jacobian(double, double, odex::algebra::band_matrix<double>& J) const
+        {
+            J.resize(1);
+            J(0, 0) = -1;
+        }
+    };
+    for (auto const& config : configs)
+    {
+        auto weights = std::get<2>(odex::detail::make_extrap_config<double>(config[0], config[1], method));
+        double sum = 0;
+        for (auto weight : weights)
+        {
+            sum += weight;
+        }
+        assert(std::abs(sum-1) < 1e-10 && weights.size() == config[0]/2);
+
+        auto exstepper = odex::make_extrapolation_stepper<odex::steppers::linearly_implicit>(decay{}, 1.0, config[0],
+                                                                                             config[1], false);
+        double y = 1;
+        exstepper.step(y, 0.0, 1e-2, std::size_t(20));
+        auto const tolerance = config[0] < 8 ? 1e-8 : 1e-12;
+        assert(std::abs(y-std::exp(-0.2)) < tolerance && "linearly implicit error too large!");
+    }
+
+    // a diffusion eigenmode decays at its semi-discrete rate with time steps
+    // far beyond the explicit stability limit, and evaluating in parallel
+    // makes one Jacobian evaluation per step
+    constexpr std::size_t npoints = 63;
+    using state_type = Eigen::Matrix<double, Eigen::Dynamic, 1>;
+    using counting_diffuser = jacobian_counter<diffuser<double, state_type>>;
+    auto const k = 1.0/double(npoints+1);
+    auto const pi = std::acos(-1.0);
+    auto const rate = -4/(k*k)*std::pow(std::sin(pi*k/2), 2);
+    state_type u0(npoints);
+    for (std::size_t ii = 0; ii < npoints; ++ii)
+    {
+        u0[std::ptrdiff_t(ii)] = std::sin(pi*k*double(ii+1));
+    }
+
+    auto const dt = 1e-2;
+    auto const nsteps = std::size_t(10);
+    state_type serial;
+    for (bool parallel : { false, true })
+    {
+        counting_diffuser system(k, 1, 0);
+        auto exstepper = odex::make_extrapolation_stepper<odex::steppers::linearly_implicit>(system, u0, 8, 3, parallel);
+        state_type u = u0;
+        exstepper.step(u, 0.0, dt, nsteps);
+        assert((u-std::exp(rate*dt*double(nsteps))*u0).norm() < 1e-8*u0.norm() && "diffusion decay inaccurate!");
+        assert(*system.evaluations == nsteps && "Jacobian not shared across partitions!");
+        if (parallel)
+        {
+            assert((u-serial).norm() <= 1e-14*serial.norm() && "parallel result differs from serial!");
+        }
+        serial = u;
+    }
+
+    // stiff reaction-diffusion stays bounded and decays, where an explicit
+    // step of the same size blows up
+    diffuser<double, state_type> system(k, 1, 100);
+    auto exstepper = odex::make_extrapolation_stepper<odex::steppers::linearly_implicit>(system, u0, 12, 3, true);
+    state_type u = u0;
+    exstepper.step(u, 0.0, 0.1, std::size_t(10));
+    assert(u.allFinite() && u.norm() < 1e-3*u0.norm() && "linearly implicit stepper unstable!");
+    auto explicit_stepper = odex::make_extrapolation_stepper(system, u0, 8, 3, false);
+    state_type v = u0;
+    explicit_stepper.step(v, 0.0, 0.1, std::size_t(2));
+    assert(!(v.norm() < u0.norm()) && "explicit stepper unexpectedly stable!");
+}
+
+static void test_imex()
+{
+    constexpr std::size_t npoints = 63;
+    using state_type = Eigen::Matrix<double, Eigen::Dynamic, 1>;
+    auto const k = 1.0/double(npoints+1);
+    auto const pi = std::acos(-1.0);
+    state_type u0(npoints);
+    for (std::size_t ii = 0; ii < npoints; ++ii)
+    {
+        auto const x = k*double(ii+1);
+        u0[std::ptrdiff_t(ii)] = std::sin(pi*x)+0.5*std::sin(3*pi*x);
+    }
+
+    // the reference treats the whole system linearly implicitly with small
+    // steps
+    diffuser<double, state_type> full(k, 1, 4);
+    auto reference_stepper = odex::make_extrapolation_stepper<odex::steppers::linearly_implicit>(full, u0, 12, 3, false);
+    state_type reference = u0;
+    reference_stepper.step(reference, 0.0, 1e-4, std::size_t(200));
+
+    // the split system stepped with a hundred times the explicit stability
+    // limit matches it, whether it supplies a banded operator or solves its
+    // own linear systems, in serial or in parallel
+    state_type banded_result;
+    for (bool parallel : { false, true })
+    {
+        split_diffuser<double, state_type> banded(npoints, 1, 4);
+        solving_diffuser<double, state_type> solving(npoints, 1, 4);
+        auto banded_stepper = odex::make_extrapolation_stepper<odex::steppers::imex>(banded, u0, 8, 3, parallel);
+        auto solving_stepper = odex::make_extrapolation_stepper<odex::steppers::imex>(solving, u0, 8, 3, parallel);
+        assert(banded_stepper.isbn() <= 0 && "imex schemes have no stability boundary to report!");
+        state_type u = u0;
+        state_type v = u0;
+        banded_stepper.step(u, 0.0, 1e-2, std::size_t(2));
+        solving_stepper.step(v, 0.0, 1e-2, std::size_t(2));
+        assert((u-reference).norm() < 1e-7*reference.norm() && "imex result inaccurate!");
+        assert((u-v).norm() < 1e-12*u.norm() && "banded and solving imex steppers differ!");
+        if (parallel)
+        {
+            assert((u-banded_result).norm() <= 1e-14*u.norm() && "parallel result differs from serial!");
+        }
+        banded_result = u;
+    }
+
+    // changing the time step size refactors the banded operator
+    split_diffuser<double, state_type> banded(npoints, 1, 4);
+    auto imex_stepper = odex::make_extrapolation_stepper<odex::steppers::imex>(banded, u0, 8, 3, true);
+    state_type u = u0;
+    imex_stepper.step(u, 0.0, 5e-3, std::size_t(2));
+    imex_stepper.step(u, 1e-2, 1e-2, std::size_t(1));
+    assert((u-reference).norm() < 1e-7*reference.norm() && "imex result inaccurate after changing dt!");
+
+    // the order of accuracy of the extrapolation survives the splitting,
+    // measured with weak diffusion since stiff problems reduce the order
+    diffuser<double, state_type> weak(k, 1e-3, 4);
+    auto weak_stepper = odex::make_extrapolation_stepper<odex::steppers::linearly_implicit>(weak, u0, 12, 3, false);
+    state_type weak_reference = u0;
+    weak_stepper.step(weak_reference, 0.0, 1e-3, std::size_t(200));
+    auto error = [&](double dt)
+    {
+        split_diffuser<double, state_type> system(npoints, 1e-3, 4);
+        auto exstepper = odex::make_extrapolation_stepper<odex::steppers::imex>(system, u0, 4, 2, false);
+        state_type w = u0;
+        exstepper.step(w, 0.0, dt, std::size_t(0.2/dt+0.5));
+        return (w-weak_reference).norm();
+    };
+    auto const rate = std::log2(error(1e-2)/error(5e-3));
+    std::cout << "IMEX_{4,2} convergence rate on split reaction-diffusion: " << rate << std::endl;
+    assert(rate > 3.5 && "imex stepper lost its order of accuracy!");
+}
+
+/// Scalar state without operators, whose arithmetic goes through its own
+/// operations so that a test can count the partitions folded into the result.
+struct folded_scalar
+{
+    double value;
+};
+
+/// Number of combinations and accumulations of folded_scalar states.
+static std::atomic<std::size_t> folded_scalar_folds(0);
+
+namespace odex {
+namespace algebra {
+
+template <>
+struct operations<folded_scalar>
+{
+    static void axpy(folded_scalar& y, double a, folded_scalar const& x)
+    {
+        y.value += a*x.value;
+    }
+
+    static void scale_sum2(folded_scalar& y, double a1, folded_scalar const& x1, double a2, folded_scalar const& x2)
+    {
+        y.value = a1*x1.value + a2*x2.value;
+    }
+
+    static void scale_sum3(folded_scalar& y, double a1, folded_scalar const& x1, double a2, folded_scalar const& x2,
+                           double a3, folded_scalar const& x3)
+    {
+        y.value = a1*x1.value + a2*x2.value + a3*x3.value;
+    }
+
+    static void combine(folded_scalar& y, double const* weights, folded_scalar const* const* inputs,
+                        std::size_t count, summation)
+    {
+        y.value = 0;
+        accumulate(y, weights, inputs, count, summation::plain);
+    }
+
+    static void accumulate(folded_scalar& y, double const* weights, folded_scalar const* const* inputs,
+                           std::size_t count, summation)
+    {
+        for (std::size_t jj = 0; jj < count; ++jj)
+        {
+            y.value += weights[jj]*inputs[jj]->value;
+        }
+        ++folded_scalar_folds;
+    }
+};
+
+} // namespace algebra
+} // namespace odex
+
+/// Exponential growth system whose copy held by the stepping thread's
+/// partition waits, on its first evaluation, for another partition to be
+/// folded, and records whether one was before it gave up.
+struct fold_waiting_system
+{
+    fold_waiting_system(std::shared_ptr<std::atomic<int>> copies, std::shared_ptr<std::atomic<bool>> overlapped)
+    : m_copies(std::move(copies)), m_overlapped(std::move(overlapped)), m_id((*m_copies)++), m_waited(false)
+    {    }
+
+    fold_waiting_system(fold_waiting_system const& other)
+    : m_copies(other.m_copies), m_overlapped(other.m_overlapped), m_id((*m_copies)++), m_waited(false)
+    {    }
+
+    folded_scalar operator()(double, folded_scalar y) const
+    {
+        // copy 0 is the prototype and copy 1 is held by the stepping thread
+        if (m_id == 1 && !m_waited)
+        {
+            m_waited = true;
+            auto end = std::chrono::steady_clock::now()+std::chrono::seconds(2);
+            while (folded_scalar_folds == 0 && std::chrono::steady_clock::now() < end)
+            {
+                std::this_thread::yield();
+            }
+            *m_overlapped = folded_scalar_folds > 0;
+        }
+        return y;
+    }
+
+    std::shared_ptr<std::atomic<int>> m_copies;
+    std::shared_ptr<std::atomic<bool>> m_overlapped;
+    int m_id;
+    mutable bool m_waited;
+};
+
+static void test_streaming_overlap()
+{
+    // the stepping thread runs the heaviest partition, so the combination
+    // only overlaps with it if the lighter partitions are folded first
+    std::vector<std::array<std::size_t,2>> configs = { {8,3}, {12,4}, {16,5} };
+    for (std::size_t ii = 0; ii < configs.size(); ++ii)
+    {
+        auto overlapped = std::make_shared<std::atomic<bool>>(false);
+        fold_waiting_system system(std::make_shared<std::atomic<int>>(0), overlapped);
+
+        odex::extrapolation_options options;
+        options.combination = odex::combination::streaming;
+        auto exstepper = odex::make_extrapolation_stepper(system, folded_scalar{1}, configs[ii][0], configs[ii][1],
+                                                          true, options);
+        folded_scalar_folds = 0;
+        folded_scalar y{1};
+        exstepper.step(y, 0.0, 1e-2, std::size_t(1));
+        assert(*overlapped && "no partition was folded while the stepping thread's ran!");
+        assert(std::abs(y.value-std::exp(1e-2)) < 1e-12 && "odex error too large!");
+    }
+}
+
+static void test_parallel_combination()
+{
+    constexpr std::size_t npoints = 48;
+    using value_type = double;
+    using state_type = matrix<value_type, npoints, npoints>;
+    using system_type = convector<value_type, state_type>;
+
+    system_type system(1, 0.5, 0.25);
+    state_type u0;
+    for (std::ptrdiff_t ii = 0; ii < ptrdiff_t(npoints); ++ii)
+    {
+        for (std::ptrdiff_t jj = 0; jj < ptrdiff_t(npoints); ++jj)
+        {
+            u0(ii,jj) = std::sin(0.1*double(ii))*std::cos(0.2*double(jj));
+        }
+    }
+
+    auto run = [&](std::size_t cores, odex::extrapolation_options const& options)
+    {
+        auto exstepper = odex::make_extrapolation_stepper(system, u0, 8, cores, true, options);
+        state_type u = u0;
+        exstepper.step(u, 0.0, 1e-5, std::size_t(8));
+        return u;
+    };
+
+    // splitting the combination into index ranges must not change the result,
+    // including ranges that end short of a whole tile
+    std::vector<std::size_t> configs = { 3, 6, 8 };
+    for (auto cores : configs)
+    {
+        odex::extrapolation_options options;
+        state_type serial = run(cores, options);
+
+        options.combine_grain = 1;
+        state_type split = run(cores, options);
+        assert(split == serial);
+
+        options.executor = odex::threading::default_executor();
+        state_type shared = run(cores, options);
+        assert(shared == serial);
+    }
+
+    // folding partitions lightest first as they finish changes the order of
+    // the sum, but not from one run to the next
+    for (auto cores : configs)
+    {
+        odex::extrapolation_options options;
+        state_type deferred = run(cores, options);
+
+        options.combination = odex::combination::streaming;
+        state_type streaming = run(cores, options);
+        assert((streaming-deferred).norm() <= 1e-13*deferred.norm());
+        for (std::size_t ii = 0; ii < 10; ++ii)
+        {
+            assert(run(cores, options) == streaming);
+        }
+
+        options.executor = odex::threading::default_executor();
+        assert(run(cores, options) == streaming);
+    }
+
+    // summing the weighted outputs of each partition as its steppers finish,
+    // whether the stepper accumulates by itself or not
+    for (auto cores : configs)
+    {
+        odex::extrapolation_options options;
+        state_type deferred = run(cores, options);
+
+        options.combination = odex::combination::accumulated;
+        state_type accumulated = run(cores, options);
+        assert((accumulated-deferred).norm() <= 1e-12*deferred.norm());
+
+        using stepper_type = storing_stepper<odex::steppers::gbs<state_type>>;
+        auto weights = std::get<2>(odex::detail::make_extrap_config<double>(8, cores));
+        auto step_counts = std::get<1>(odex::detail::make_extrap_config<double>(8, cores));
+        odex::extrapolation_stepper<system_type, stepper_type, state_type, double> exstepper(
+            stepper_type(), system, step_counts.size(), step_counts.begin(), weights.begin(), 8, 0.0f, true, options);
+        state_type u = u0;
+        exstepper.step(u, 0.0, 1e-5, std::size_t(8));
+        assert((u-deferred).norm() <= 1e-12*deferred.norm());
+    }
+}
+
 static void test_convection_2d()
 {
     std::vector<std::array<std::size_t,2>> configs = { {8,3}, {8,6}, {8,8}, {12,4}, {12,8}, {16,5} };
@@ -137,8 +1134,477 @@ static void test_convection_2d()
     }
 }
 
+static void test_step_async()
+{
+    auto system = [](auto, auto y)
+    {
+        return y;
+    };
+
+    std::size_t nsteps = 32;
+    double t0 = 0;
+    double dt = 2.0/double(nsteps);
+    double y0 = 1;
+
+    // reference result from the blocking call
+    auto exstepper = odex::make_extrapolation_stepper(system, y0, 8, 6, true);
+    double expected = y0;
+    exstepper.step(expected, t0, dt, nsteps);
+
+    // the observer holds the background thread at the first step, so we can
+    // check that the caller's state is untouched while the steps run
+    std::promise<void> gate;
+    std::shared_future<void> opened(gate.get_future());
+    std::size_t count = 0;
+    auto observer = [opened, &count](double, double)
+    {
+        opened.wait();
+        ++count;
+    };
+
+    double y = y0;
+    auto handle = exstepper.step_async(y, t0, dt, nsteps, observer);
+    assert(handle.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready);
+    assert(y == y0);
+    gate.set_value();
+    handle.get();
+    assert(y == expected);
+    assert(count == nsteps);
+
+    // the stepper can be reused, and integrate_async gives the same answer
+    y = y0;
+    exstepper.step_async(y, t0, dt, nsteps).wait();
+    assert(y == expected);
+
+    // calls issued back to back, each as soon as the last one's future is
+    // ready, while the background thread may still be leaving the last task
+    for (std::size_t ii = 0; ii < 100; ++ii)
+    {
+        y = y0;
+        exstepper.step_async(y, t0, dt, std::size_t(1)).get();
+    }
+    auto result = odex::integrate_async(system, y0, t0, dt, nsteps, odex::observers::null_observer{}, 8, 6);
+    assert(result.get() == expected);
+}
+
+static void test_async_observer()
+{
+    auto system = [](auto, auto y)
+    {
+        return y;
+    };
+
+    std::size_t nsteps = 64;
+    double t0 = 0;
+    double dt = 1.0/double(nsteps);
+    double y0 = 1;
+
+    // reference outputs from a synchronous observer
+    std::vector<double> expected;
+    auto record = [&expected](double, double y){ expected.push_back(y); };
+    odex::integrate(system, y0, t0, dt, nsteps, record, 8, 3);
+
+    // blocking backpressure observes every output, in order
+    {
+        std::vector<double> observed;
+        auto slow = [&observed](double, double y)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            observed.push_back(y);
+        };
+        auto observer = odex::observers::make_async_observer<double>(slow, y0, 4);
+        odex::integrate(system, y0, t0, dt, nsteps, observer, 8, 3);
+        observer.flush();
+        assert(observed == expected);
+        assert(observer.dropped() == 0);
+    }
+
+    // dropping backpressure never stalls, and what is observed is in order
+    {
+        std::vector<double> observed;
+        auto slow = [&observed](double, double y)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            observed.push_back(y);
+        };
+        auto observer = odex::observers::make_async_observer<double>(slow, y0, 2, odex::observers::backpressure::drop);
+        odex::integrate(system, y0, t0, dt, nsteps, observer, 8, 3);
+        observer.flush();
+        assert(observed.size()+observer.dropped() == nsteps);
+        assert(std::is_sorted(observed.begin(), observed.end()));
+    }
+
+    // a depth of zero still holds one pending output
+    {
+        std::vector<double> observed;
+        auto observer = odex::observers::make_async_observer<double>(
+            [&observed](double, double y){ observed.push_back(y); }, y0, 0);
+        odex::integrate(system, y0, t0, dt, nsteps, observer, 8, 3);
+        observer.flush();
+        assert(observed == expected);
+    }
+}
+
+/// Exponential growth system that burns a fixed amount of time per evaluation.
+/// Every copy gets a sequence id, and the copy with id slow_id is several
+/// times more expensive, emulating a noisy neighbor on one core.
+struct imbalanced_system
+{
+    imbalanced_system(std::shared_ptr<std::atomic<int>> copies, int slow_id)
+    : m_copies(std::move(copies)), m_id((*m_copies)++), m_slow_id(slow_id)
+    {    }
+
+    imbalanced_system(imbalanced_system const& other)
+    : m_copies(other.m_copies), m_id((*m_copies)++), m_slow_id(other.m_slow_id)
+    {    }
+
+    double operator()(double, double y) const
+    {
+        auto cost = std::chrono::microseconds(m_id == m_slow_id ? 8 : 2);
+        auto end = std::chrono::steady_clock::now()+cost;
+        while (std::chrono::steady_clock::now() < end) { }
+        return y;
+    }
+
+    std::shared_ptr<std::atomic<int>> m_copies;
+    int m_id;
+    int m_slow_id;
+};
+
+static double run_imbalanced(std::size_t order, std::size_t cores, odex::scheduling scheduling)
+{
+    // copy 0 is the prototype and copy 1 is held by the stepping thread's
+    // partition, so the stepping thread becomes the slow one
+    imbalanced_system system(std::make_shared<std::atomic<int>>(0), 1);
+
+    odex::extrapolation_options options;
+    options.scheduling = scheduling;
+    auto exstepper = odex::make_extrapolation_stepper(system, 1.0, order, cores, true, options);
+
+    std::size_t nsteps = 20;
+    double y = 1;
+    auto begin_time = std::chrono::steady_clock::now();
+    exstepper.step(y, 0.0, 1e-2, nsteps);
+    auto end_time = std::chrono::steady_clock::now();
+    assert(std::abs(y-std::exp(0.2)) < 1e-12 && "odex error too large!");
+    return std::chrono::duration<double, std::micro>(end_time-begin_time).count()/double(nsteps);
+}
+
+/// Run the 2D convection problem with the given state precision and
+/// extrapolation weight precision, returning the result in double and the
+/// time per step in microseconds.  Streaming combination runs in parallel,
+/// the other combinations serially.
+template <class Value, class Weight>
+static std::pair<matrix<double,128,128>, double> run_precision(std::size_t order, std::size_t cores,
+                                                               odex::algebra::summation summation,
+                                                               odex::combination combination = odex::combination::deferred)
+{
+    constexpr std::size_t npoints = 128;
+    using state_type = matrix<Value, npoints, npoints>;
+    using system_type = convector<Value, state_type>;
+
+    system_type system(1, Value(0.5), Value(0.25));
+    state_type u;
+    for (std::ptrdiff_t ii = 0; ii < ptrdiff_t(npoints); ++ii)
+    {
+        for (std::ptrdiff_t jj = 0; jj < ptrdiff_t(npoints); ++jj)
+        {
+            double x = static_cast<double>(ii)/npoints-.5;
+            double y = static_cast<double>(jj)/npoints-.5;
+            u(ii,jj) = static_cast<Value>(std::exp(-60*(x*x+y*y)));
+        }
+    }
+
+    odex::extrapolation_options options;
+    options.summation = summation;
+    options.combination = combination;
+    auto const parallel = combination == odex::combination::streaming;
+    auto exstepper = odex::make_extrapolation_stepper<Weight>(system, u, order, cores, parallel, options);
+
+    std::size_t nsteps = 8;
+    auto begin_time = std::chrono::steady_clock::now();
+    exstepper.step(u, Value(0), Value(1e-3), nsteps);
+    auto end_time = std::chrono::steady_clock::now();
+    auto duration = std::chrono::duration<double, std::micro>(end_time-begin_time).count()/double(nsteps);
+    return { u.template cast<double>(), duration };
+}
+
+/// Relative errors of combining the float outputs of the GBS sequences of an
+/// extrapolation scheme with float weights, with double weights, and with
+/// double weights and compensated summation, against the combination of the
+/// same float outputs in double.  This leaves out the rounding of the
+/// sequences themselves, which the combination cannot recover.
+static std::array<double,3> combination_errors(std::size_t order, std::size_t cores)
+{
+    constexpr std::size_t npoints = 128;
+    using state_type = matrix<float, npoints, npoints>;
+    using stepper_type = odex::steppers::gbs<state_type>;
+    using odex::algebra::summation;
+
+    convector<float, state_type> system(1, 0.5f, 0.25f);
+    state_type u0;
+    for (std::ptrdiff_t ii = 0; ii < ptrdiff_t(npoints); ++ii)
+    {
+        for (std::ptrdiff_t jj = 0; jj < ptrdiff_t(npoints); ++jj)
+        {
+            double x = static_cast<double>(ii)/npoints-.5;
+            double y = static_cast<double>(jj)/npoints-.5;
+            u0(ii,jj) = static_cast<float>(std::exp(-60*(x*x+y*y)));
+        }
+    }
+
+    auto const config = odex::detail::make_extrap_config<double>(order, cores);
+    auto const& step_counts = std::get<1>(config);
+    auto const& weights = std::get<2>(config);
+    std::vector<float> const float_weights(weights.begin(), weights.end());
+
+    state_type const fval0 = system(0.0f, u0);
+    stepper_type::scratch_type scratch;
+    std::vector<state_type> outputs(step_counts.size());
+    std::vector<state_type const*> inputs(step_counts.size());
+    matrix<double, npoints, npoints> reference = matrix<double, npoints, npoints>::Zero(npoints, npoints);
+    for (std::size_t jj = 0; jj < step_counts.size(); ++jj)
+    {
+        stepper_type::step(system, u0, outputs[jj], 0.0f, 1e-3f, step_counts[jj], fval0, scratch);
+        inputs[jj] = &outputs[jj];
+        reference += weights[jj]*outputs[jj].cast<double>();
+    }
+
+    auto error = [&](auto const* current_weights, summation method)
+    {
+        state_type y;
+        odex::algebra::combine(y, current_weights, inputs.data(), inputs.size(), method);
+        return (y.cast<double>()-reference).norm()/reference.norm();
+    };
+    return {{ error(float_weights.data(), summation::plain), error(weights.data(), summation::plain),
+              error(weights.data(), summation::compensated) }};
+}
+
+static void test_mixed_precision()
+{
+    using odex::algebra::summation;
+    std::vector<std::array<std::size_t,2>> configs = { {8,3}, {8,8}, {12,4}, {12,8}, {16,5} };
+
+    for (std::size_t ii = 0; ii < configs.size(); ++ii)
+    {
+        auto order = configs[ii][0];
+        auto cores = configs[ii][1];
+        auto reference = run_precision<double, double>(order, cores, summation::plain);
+        auto single = run_precision<float, float>(order, cores, summation::plain);
+        auto mixed = run_precision<float, double>(order, cores, summation::plain);
+        auto compensated = run_precision<float, double>(order, cores, summation::compensated);
+        auto streaming = run_precision<float, double>(order, cores, summation::compensated,
+                                                      odex::combination::streaming);
+
+        auto error = [&](auto const& result)
+        {
+            return (result.first-reference.first).norm()/reference.first.norm();
+        };
+        std::cout << "GBS_{" << order << "," << cores << "} float state, relative error: float weights "
+                  << error(single) << ", double weights " << error(mixed) << ", compensated " << error(compensated)
+                  << ", streaming " << error(streaming) << "; us/step double " << reference.second << ", float " << mixed.second << std::endl;
+
+        // the error is dominated by the rounding of the float sequences,
+        // amplified by the magnitudes of the weights, rather than by the
+        // precision of the combination itself
+        assert(error(mixed) < 1e-3 && "mixed precision error too large!");
+        assert(error(compensated) < 1e-3 && "mixed precision error too large!");
+
+        // streaming rounds the running sum to float after every partition
+        assert(error(streaming) < 1e-3 && "mixed precision error too large!");
+
+        // the combination on its own, where the precision of the weights and
+        // of the sum does show
+        auto const combined = combination_errors(order, cores);
+        std::cout << "GBS_{" << order << "," << cores << "} combination of float outputs, relative error: "
+                  << "float weights " << combined[0] << ", double weights " << combined[1]
+                  << ", compensated " << combined[2] << std::endl;
+
+        // the large alternating weights of the high order schemes cancel
+        // away the low bits of a float sum, leaving an error well above the
+        // final rounding to float
+        if (order >= 12 && cores >= 5)
+        {
+            assert(10*combined[1] < combined[0] && "double weights must reduce the combination error!");
+            assert(10*combined[2] < combined[0] && "compensated summation must reduce the combination error!");
+        }
+    }
+}
+
+/// Step a system whose state has elements of type Value with Value weights,
+/// so that stepping and combination both stay in that precision, returning
+/// the time per step in microseconds.  A first step sizes the buffers.
+template <class Value, class System, class State>
+static double time_pipeline(System const& system, State& u, Value dt, std::size_t nsteps)
+{
+    auto exstepper = odex::make_extrapolation_stepper<Value>(system, u, 8, 3, false);
+    exstepper.step(u, Value(0), dt, std::size_t(1));
+
+    auto begin_time = std::chrono::steady_clock::now();
+    exstepper.step(u, dt, dt, nsteps);
+    auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end_time-begin_time).count()/double(nsteps);
+}
+
+/// Transport of a Gaussian pulse over a periodic grid of npoints, returning
+/// the result in double and the time per step.
+template <class Value>
+static std::pair<Eigen::VectorXd, double> run_transport(std::ptrdiff_t npoints, std::size_t nsteps)
+{
+    using state_type = Eigen::Array<Value, Eigen::Dynamic, 1>;
+    auto const k = Value(1)/static_cast<Value>(npoints);
+    transport<Value, state_type> system(1, k);
+
+    state_type u(npoints);
+    for (std::ptrdiff_t ii = 0; ii < npoints; ++ii)
+    {
+        double x = static_cast<double>(ii)/static_cast<double>(npoints)-.5;
+        u[ii] = static_cast<Value>(std::exp(-60*x*x));
+    }
+    auto time = time_pipeline(system, u, k/4, nsteps);
+    return { u.matrix().template cast<double>(), time };
+}
+
+/// The 2D convection problem over npoints by npoints, returning the result in
+/// double and the time per step.
+template <class Value, int N>
+static std::pair<matrix<double,N,N>, double> run_convection(std::size_t nsteps)
+{
+    using state_type = matrix<Value, N, N>;
+    convector<Value, state_type> system(1, Value(0.5), Value(0.25));
+
+    state_type u;
+    for (std::ptrdiff_t ii = 0; ii < N; ++ii)
+    {
+        for (std::ptrdiff_t jj = 0; jj < N; ++jj)
+        {
+            double x = static_cast<double>(ii)/N-.5;
+            double y = static_cast<double>(jj)/N-.5;
+            u(ii,jj) = static_cast<Value>(std::exp(-60*(x*x+y*y)));
+        }
+    }
+    auto time = time_pipeline(system, u, Value(1e-3), nsteps);
+    return { u.template cast<double>(), time };
+}
+
+static void test_long_double()
+{
+    static_assert(std::is_same<odex::detail::weight_t<void, float>, double>::value,
+                  "float states default to double weights");
+    static_assert(std::is_same<odex::detail::weight_t<void, long double>, long double>::value,
+                  "long double states default to long double weights");
+
+    // exponential growth, accurate beyond double precision
+    auto system = [](long double, long double y)
+    {
+        return y;
+    };
+    auto exstepper = odex::make_extrapolation_stepper(system, 1.0L, 8, 3, false);
+    long double y = 1;
+    exstepper.step(y, 0.0L, 1e-3L, std::size_t(100));
+    auto error = std::abs(y-std::exp(0.1L))/std::exp(0.1L);
+    std::cout << "long double exponential growth, relative error " << static_cast<double>(error) << std::endl;
+    assert(error < 1e-17L && "long double error too large!");
+}
+
+static void benchmark_float_pipeline()
+{
+    auto report = [](char const* name, auto const& reference, auto const& single)
+    {
+        auto error = (single.first-reference.first).norm()/reference.first.norm();
+        std::cout << name << ": double " << reference.second << " us/step, float " << single.second
+                  << " us/step, speedup " << reference.second/single.second
+                  << ", relative difference " << error << std::endl;
+        assert(error < 1e-3 && "float pipeline error too large!");
+    };
+
+    report("Transport1D, 2^20 points", run_transport<double>(1 << 20, 4), run_transport<float>(1 << 20, 4));
+    report("Convection, 512x512", run_convection<double, 512>(4), run_convection<float, 512>(4));
+}
+
+static void benchmark_scheduling()
+{
+    std::vector<std::array<std::size_t,2>> configs = { {8,3}, {8,6}, {8,8}, {12,8} };
+
+    for (std::size_t ii = 0; ii < configs.size(); ++ii)
+    {
+        auto order = configs[ii][0];
+        auto cores = configs[ii][1];
+        auto makespan_static = run_imbalanced(order, cores, odex::scheduling::static_partition);
+        auto makespan_dynamic = run_imbalanced(order, cores, odex::scheduling::dynamic);
+        std::cout << "GBS_{" << order << "," << cores << "} with one slow core: makespan static "
+                  << makespan_static << " us/step, dynamic " << makespan_dynamic << " us/step" << std::endl;
+    }
+}
+
+template <int N>
+static void benchmark_combination()
+{
+    using state_type = matrix<double,N,N>;
+
+    auto weights = std::get<2>(odex::detail::make_extrap_config<double>(8, 8));
+    auto const count = weights.size();
+
+    std::vector<state_type> outputs(count);
+    std::vector<state_type const*> inputs(count);
+    for (std::size_t jj = 0; jj < count; ++jj)
+    {
+        outputs[jj].setRandom();
+        inputs[jj] = &outputs[jj];
+    }
+
+    state_type naive, fused;
+    std::size_t const nreps = 13107200/(N*N);
+
+    auto begin_time = std::chrono::steady_clock::now();
+    for (std::size_t rep = 0; rep < nreps; ++rep)
+    {
+        naive = weights[0]*outputs[0];
+        for (std::size_t jj = 1; jj < count; ++jj)
+        {
+            naive += weights[jj]*outputs[jj];
+        }
+    }
+    auto naive_time = std::chrono::duration<double>(std::chrono::steady_clock::now()-begin_time).count();
+
+    begin_time = std::chrono::steady_clock::now();
+    for (std::size_t rep = 0; rep < nreps; ++rep)
+    {
+        odex::algebra::combine(fused, weights.data(), inputs.data(), count);
+    }
+    auto fused_time = std::chrono::duration<double>(std::chrono::steady_clock::now()-begin_time).count();
+
+    auto const error = (fused-naive).norm()/naive.norm();
+    assert(error < 1e-12 && "fused combination disagrees with the operator loop!");
+
+    // both compute the same combination, so their times compare directly
+    std::cout << "Combination of " << count << " " << N << "x" << N << " outputs: operator loop "
+              << naive_time/double(nreps)*1e6 << " us, fused "
+              << fused_time/double(nreps)*1e6 << " us, " << naive_time/fused_time
+              << "x the speed of the operator loop" << std::endl;
+}
+
 int main()
 {
     test_simple_ode();
+    test_step_async();
+    test_async_observer();
+    test_convection_team();
+    test_system_protocols();
+    test_parallel_combination();
+    test_streaming_overlap();
+    test_shared_derivative();
+    test_compact_gbs();
+    test_midpoint();
+    test_band_matrix();
+    test_linearly_implicit();
+    test_imex();
+    test_standard_containers();
+    test_mixed_precision();
+    test_long_double();
+    benchmark_float_pipeline();
+    benchmark_scheduling();
+    benchmark_combination<256>();
+    benchmark_combination<1024>();
     test_convection_2d();
 }
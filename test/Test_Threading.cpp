@@ -1,10 +1,16 @@
 
 #include "odex/threading/pool.hpp"
 #include "odex/threading/worker.hpp"
+#include "odex/threading/affinity.hpp"
+#include "odex/threading/shared_pool.hpp"
+#include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <cstdint>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <vector>
 
 struct target
 {
@@ -49,14 +55,14 @@ static void test_worker_notify()
     assert(targ.counter == iters);
 }
 
-static void test_thread_pool()
+static void test_thread_pool(odex::threading::wait_policy policy)
 {
     std::size_t const num_workers = 4;
     std::size_t const iters = 10;
 
     target targets[num_workers];
 
-    odex::threading::pool pool(num_workers);
+    odex::threading::pool pool(num_workers, policy);
     for (std::size_t ii = 0; ii < num_workers; ++ii)
     {
         pool.emplace(ii, std::ref(targets[ii]));
@@ -96,8 +102,199 @@ static void test_thread_pool()
     pool.join();
 }
 
+static void test_thread_pool_process(odex::threading::wait_policy policy)
+{
+    std::size_t const num_workers = 4;
+    std::size_t const iters = 1000;
+
+    target targets[num_workers];
+
+    odex::threading::pool pool(num_workers, policy);
+    for (std::size_t ii = 0; ii < num_workers; ++ii)
+    {
+        pool.emplace(ii, std::ref(targets[ii]));
+    }
+
+    // process() must not return before every worker has run
+    for (std::size_t ii = 0; ii < iters; ++ii)
+    {
+        pool.process();
+        for (std::size_t jj = 0; jj < num_workers; ++jj)
+        {
+            assert(targets[jj].counter == int(ii+1));
+        }
+    }
+
+    // the calling thread can take a share of the work
+    target local;
+    for (std::size_t ii = 0; ii < iters; ++ii)
+    {
+        pool.process(std::ref(local));
+        assert(local.counter == int(ii+1));
+        for (std::size_t jj = 0; jj < num_workers; ++jj)
+        {
+            assert(targets[jj].counter == int(iters+ii+1));
+        }
+    }
+}
+
+static void test_affinity()
+{
+    using odex::threading::affinity;
+
+    auto topology = odex::threading::cpu_topology();
+    assert(!topology.empty());
+
+    // every placement yields one entry per thread, wrapping if needed
+    std::size_t const count = 2*topology.size()+1;
+    assert(affinity::none().cpus(count) == std::vector<int>(count, -1));
+    for (auto const& placement : { affinity::compact(), affinity::scatter(), affinity::physical_cores() })
+    {
+        auto cpus = placement.cpus(count);
+        assert(cpus.size() == count);
+        for (auto cpu : cpus)
+        {
+            assert(std::any_of(topology.begin(), topology.end(), [cpu](auto const& info){ return info.id == cpu; }));
+        }
+    }
+    auto cpus = affinity::cores({topology[0].id}).cpus(3);
+    assert(cpus == std::vector<int>(3, topology[0].id));
+
+    // pinned workers still process
+    odex::threading::pool pool(2, odex::threading::wait_policy::blocking(), affinity::compact().cpus(2));
+    target targets[2];
+    pool.emplace(0, std::ref(targets[0]));
+    pool.emplace(1, std::ref(targets[1]));
+    pool.process();
+    assert(targets[0].counter == 1 && targets[1].counter == 1);
+}
+
+static void test_shared_pool()
+{
+    std::size_t const num_callers = 4;
+    std::size_t const num_tasks = 7;
+    std::size_t const iters = 200;
+
+    odex::threading::shared_pool pool(3);
+    assert(pool.concurrency() == 3);
+
+    // several threads submit batches concurrently; every task of every batch
+    // must have run exactly once when bulk_run returns
+    std::vector<std::thread> callers;
+    std::atomic<bool> ok(true);
+    for (std::size_t ii = 0; ii < num_callers; ++ii)
+    {
+        callers.emplace_back([&]()
+        {
+            std::vector<std::atomic<int>> counts(num_tasks);
+            auto task = [&counts](std::size_t index){ ++counts[index]; };
+            for (std::size_t jj = 0; jj < iters; ++jj)
+            {
+                pool.bulk_run(num_tasks, task);
+                for (auto const& count : counts)
+                {
+                    ok = ok && count == int(jj+1);
+                }
+            }
+        });
+    }
+    for (auto& caller : callers)
+    {
+        caller.join();
+    }
+    assert(ok);
+
+    // a pool without threads runs everything on the caller
+    odex::threading::shared_pool empty(0);
+    int sum = 0;
+    auto task = [&sum](std::size_t index){ sum += int(index); };
+    empty.bulk_run(4, task);
+    assert(sum == 6);
+}
+
+static void benchmark_dispatch(odex::threading::wait_policy policy, char const* name)
+{
+    std::size_t const num_workers = 3;
+    std::size_t const iters = 2000;
+
+    auto now = []()
+    {
+        return uint64_t(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    };
+
+    // empty targets, so all that is timed is the dispatch and completion
+    auto noop = [](){};
+    odex::threading::pool pool(num_workers, policy);
+    for (std::size_t ii = 0; ii < num_workers; ++ii)
+    {
+        pool.emplace(ii, noop);
+    }
+
+    // warm up
+    for (std::size_t ii = 0; ii < 100; ++ii)
+    {
+        pool.process();
+    }
+
+    auto begin_time = now();
+    for (std::size_t ii = 0; ii < iters; ++ii)
+    {
+        pool.process();
+    }
+    auto end_time = now();
+    std::cout << "dispatch overhead (" << name << "): " << double(end_time-begin_time)/iters << " ns/step" << std::endl;
+}
+
+static void stress_process_latency(odex::threading::wait_policy policy, char const* name)
+{
+    auto now = []()
+    {
+        return uint64_t(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    };
+
+    for (std::size_t num_workers = 2; num_workers <= 64; num_workers *= 2)
+    {
+        std::size_t const iters = 200;
+
+        std::vector<std::atomic<int>> counters(num_workers);
+        auto increment = [&counters](std::size_t index){ ++counters[index]; };
+        odex::threading::pool pool(num_workers, policy);
+        for (std::size_t ii = 0; ii < num_workers; ++ii)
+        {
+            pool.emplace(ii, increment, ii);
+        }
+
+        auto begin_time = now();
+        for (std::size_t ii = 0; ii < iters; ++ii)
+        {
+            pool.process();
+        }
+        auto end_time = now();
+
+        for (auto const& counter : counters)
+        {
+            assert(counter == int(iters));
+        }
+        std::cout << "process latency (" << name << ", " << num_workers << " workers): "
+                  << double(end_time-begin_time)/iters << " ns" << std::endl;
+    }
+}
+
 int main()
 {
+    using odex::threading::wait_policy;
+
     test_worker_notify();
-    test_thread_pool();
+    test_thread_pool(wait_policy::blocking());
+    test_thread_pool(wait_policy::spinning());
+    test_thread_pool_process(wait_policy::blocking());
+    test_thread_pool_process(wait_policy::spinning());
+    test_affinity();
+    test_shared_pool();
+
+    benchmark_dispatch(wait_policy::blocking(), "blocking");
+    benchmark_dispatch(wait_policy::spinning(), "spinning");
+
+    stress_process_latency(wait_policy::blocking(), "blocking");
+    stress_process_latency(wait_policy::spinning(), "spinning");
 }
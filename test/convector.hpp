@@ -3,6 +3,8 @@
 #define ODEX_CONVECTOR_HPP
 
 #include "central_difference.hpp"
+#include <algorithm>
+#include <cstddef>
 
 template <class T, class Matrix>
 class convector
@@ -21,7 +23,58 @@ public:
         return m_cx*m_ux+m_cy*m_uy;
     }
 
+    /// Evaluate in place, writing the time derivative into dudt.
+    void operator()(value_type, matrix_type const& u, matrix_type& dudt)
+    {
+        central_difference(u, m_k, m_ux, m_uy);
+        dudt = m_cx*m_ux+m_cy*m_uy;
+    }
+
+    /// Fused update out = base + scale*f(t, u), taking the differences and
+    /// then forming the update from them without storing the derivative.
+    void operator()(value_type, matrix_type const& u, matrix_type const& base, value_type scale, matrix_type& out)
+    {
+        central_difference(u, m_k, m_ux, m_uy);
+        out = base+scale*(m_cx*m_ux+m_cy*m_uy);
+    }
+
+    /// Evaluate with the difference loops split across a thread team.
+    template <class Team>
+    auto operator()(value_type, matrix_type const& u, Team& team)
+    {
+        _differences(u, team);
+        return m_cx*m_ux+m_cy*m_uy;
+    }
+
+    /// Evaluate in place with the difference loops split across a team.
+    template <class Team>
+    void operator()(value_type, matrix_type const& u, matrix_type& dudt, Team& team)
+    {
+        _differences(u, team);
+        dudt = m_cx*m_ux+m_cy*m_uy;
+    }
+
+    /// Fused update with the difference loops split across a team.
+    template <class Team>
+    void operator()(value_type, matrix_type const& u, matrix_type const& base, value_type scale,
+                    matrix_type& out, Team& team)
+    {
+        _differences(u, team);
+        out = base+scale*(m_cx*m_ux+m_cy*m_uy);
+    }
+
 private:
+    template <class Team>
+    void _differences(matrix_type const& u, Team& team)
+    {
+        auto count = static_cast<std::size_t>(std::max(u.rows(), u.cols()));
+        team.parallel_for(0, count, [&](std::size_t first, std::size_t last)
+        {
+            central_difference(u, m_k, m_ux, m_uy, std::ptrdiff_t(first), std::ptrdiff_t(last));
+        });
+    }
+
+
     matrix_type m_ux;
     matrix_type m_uy;
     value_type  m_k;
@@ -0,0 +1,179 @@
+
+#ifndef ODEX_DIFFUSER_HPP
+#define ODEX_DIFFUSER_HPP
+
+#include <cstddef>
+
+/// Stiff reaction-diffusion system u_t = nu*u_xx - r*u^3 on the interior
+/// points of a grid with spacing k and zero boundary values, providing its
+/// tridiagonal Jacobian for the linearly implicit steppers.  States are
+/// Eigen column vectors.
+template <class T, class Vector>
+class diffuser
+{
+public:
+    using value_type = T;
+    using vector_type = Vector;
+
+    diffuser(value_type k, value_type nu, value_type r)
+    : m_k(k), m_nu(nu), m_r(r)
+    {    }
+
+    auto operator()(value_type t, vector_type const& u)
+    {
+        vector_type dudt(u);
+        (*this)(t, u, dudt);
+        return dudt;
+    }
+
+    /// Evaluate in place, writing the time derivative into dudt.
+    void operator()(value_type, vector_type const& u, vector_type& dudt)
+    {
+        auto const n = u.size();
+        dudt.resize(u.rows(), u.cols());
+        auto const scale = m_nu/(m_k*m_k);
+        for (decltype(u.size()) ii = 0; ii < n; ++ii)
+        {
+            auto const left = ii > 0 ? u(ii-1) : value_type(0);
+            auto const right = ii+1 < n ? u(ii+1) : value_type(0);
+            dudt(ii) = scale*(left-2*u(ii)+right) - m_r*u(ii)*u(ii)*u(ii);
+        }
+    }
+
+    /// Tridiagonal Jacobian of the time derivative.
+    template <class Matrix>
+    void jacobian(value_type, vector_type const& u, Matrix& J)
+    {
+        auto const n = static_cast<std::size_t>(u.size());
+        auto const scale = m_nu/(m_k*m_k);
+        J.resize(n, 1, 1);
+        for (std::size_t ii = 0; ii < n; ++ii)
+        {
+            auto const ui = u(static_cast<decltype(u.size())>(ii));
+            J(ii, ii) = -2*scale - 3*m_r*ui*ui;
+            if (ii > 0)
+            {
+                J(ii, ii-1) = scale;
+            }
+            if (ii+1 < n)
+            {
+                J(ii, ii+1) = scale;
+            }
+        }
+    }
+
+private:
+    value_type m_k;
+    value_type m_nu;
+    value_type m_r;
+};
+
+/// The reaction-diffusion system above split into its stiff diffusion
+/// u_t = nu*u_xx, provided as a tridiagonal linear operator, and its
+/// non-stiff reaction u_t = -r*u^3, on n interior points of the unit
+/// interval.
+template <class T, class Vector>
+class split_diffuser
+{
+public:
+    using value_type = T;
+    using vector_type = Vector;
+
+    split_diffuser(std::size_t n, value_type nu, value_type r)
+    : m_n(n), m_k(1/value_type(n+1)), m_nu(nu), m_r(r)
+    {    }
+
+    /// Evaluate the reaction in place, writing it into dudt.
+    void operator()(value_type, vector_type const& u, vector_type& dudt)
+    {
+        dudt = -m_r*u.cwiseProduct(u).cwiseProduct(u);
+    }
+
+    auto operator()(value_type t, vector_type const& u)
+    {
+        vector_type dudt(u);
+        (*this)(t, u, dudt);
+        return dudt;
+    }
+
+    /// Tridiagonal diffusion operator.
+    template <class Matrix>
+    void linear_operator(Matrix& L)
+    {
+        auto const n = m_n;
+        auto const scale = m_nu/(m_k*m_k);
+        L.resize(n, 1, 1);
+        for (std::size_t ii = 0; ii < n; ++ii)
+        {
+            L(ii, ii) = -2*scale;
+            if (ii > 0)
+            {
+                L(ii, ii-1) = scale;
+            }
+            if (ii+1 < n)
+            {
+                L(ii, ii+1) = scale;
+            }
+        }
+    }
+
+protected:
+    std::size_t m_n;
+    value_type m_k;
+    value_type m_nu;
+    value_type m_r;
+};
+
+/// The split system above, applying and inverting its diffusion itself, the
+/// latter with the Thomas algorithm.
+template <class T, class Vector>
+class solving_diffuser : public split_diffuser<T, Vector>
+{
+    using base = split_diffuser<T, Vector>;
+public:
+    using value_type = T;
+    using vector_type = Vector;
+    using base::base;
+    using base::operator();
+
+    /// out = origin + scale*L*u, where out may be origin.
+    template <class Time>
+    void apply_linear(vector_type const& u, vector_type const& origin, Time scale, vector_type& out)
+    {
+        auto const n = u.size();
+        auto const factor = value_type(scale)*this->m_nu/(this->m_k*this->m_k);
+        out.resize(u.rows(), u.cols());
+        for (decltype(u.size()) ii = 0; ii < n; ++ii)
+        {
+            auto const left = ii > 0 ? u(ii-1) : value_type(0);
+            auto const right = ii+1 < n ? u(ii+1) : value_type(0);
+            out(ii) = origin(ii) + factor*(left-2*u(ii)+right);
+        }
+    }
+
+    template <class Time>
+    void solve_linear(Time h, vector_type& b)
+    {
+        auto const n = b.size();
+        auto const off = -value_type(h)*this->m_nu/(this->m_k*this->m_k);
+        auto const diagonal = 1-2*off;
+        m_upper.resize(b.rows(), b.cols());
+        auto pivot = diagonal;
+        b(0) /= pivot;
+        for (decltype(b.size()) ii = 1; ii < n; ++ii)
+        {
+            m_upper(ii-1) = off/pivot;
+            pivot = diagonal-off*m_upper(ii-1);
+            b(ii) = (b(ii)-off*b(ii-1))/pivot;
+        }
+        for (auto ii = n-1; ii-- > 0;)
+        {
+            b(ii) -= m_upper(ii)*b(ii+1);
+        }
+    }
+
+private:
+    vector_type m_upper;
+};
+
+#endif // ODEX_DIFFUSER_HPP
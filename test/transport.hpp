@@ -0,0 +1,45 @@
+#ifndef ODEX_TRANSPORT_HPP
+#define ODEX_TRANSPORT_HPP
+
+#include <cstddef>
+
+/// One dimensional transport u_t = -c*u_x on a periodic grid with spacing k,
+/// discretized with central differences.  All arithmetic is carried out in
+/// value_type.
+template <class T, class Array>
+class transport
+{
+public:
+    using value_type = T;
+    using array_type = Array;
+
+    transport(value_type c, value_type k)
+    : m_scale(-c/(2*k))
+    {    }
+
+    /// Evaluate in place, writing the time derivative into dudt.
+    void operator()(value_type, array_type const& u, array_type& dudt) const
+    {
+        auto const n = u.size();
+        dudt.resize(n);
+        dudt.segment(1,n-2) = m_scale*(u.tail(n-2)-u.head(n-2));
+        dudt[0]   = m_scale*(u[1]-u[n-1]);
+        dudt[n-1] = m_scale*(u[0]-u[n-2]);
+    }
+
+    /// Fused update out = base + scale*f(t, u) in one sweep.
+    void operator()(value_type, array_type const& u, array_type const& base, value_type scale, array_type& out) const
+    {
+        auto const n = u.size();
+        auto const s = scale*m_scale;
+        out.resize(n);
+        out.segment(1,n-2) = base.segment(1,n-2)+s*(u.tail(n-2)-u.head(n-2));
+        out[0]   = base[0]+s*(u[1]-u[n-1]);
+        out[n-1] = base[n-1]+s*(u[0]-u[n-2]);
+    }
+
+private:
+    value_type m_scale;
+};
+
+#endif // ODEX_TRANSPORT_HPP